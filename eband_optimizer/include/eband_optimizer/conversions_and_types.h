@@ -75,6 +75,214 @@ namespace eband_optimizer{
     double expansion;
   };
 
+  ///<@brief defines a bubble in the plane - position and orientation of center & radius of according hypersphere (expansion)
+  struct BubbleState
+  {
+    double x;
+    double y;
+    double theta;
+    double expansion;
+  };
+
+  ///<@brief force and torque acting on a bubble in the plane
+  struct Force2D
+  {
+    double x = 0.0;
+    double y = 0.0;
+    double torque = 0.0;
+  };
+
+  ///<@brief translation and rotation in the plane, used for differences between bubbles and step widths
+  struct Twist2D
+  {
+    double x = 0.0;
+    double y = 0.0;
+    double theta = 0.0;
+  };
+
+  /**
+   * @class Band
+   * @brief Elastic band stored as structure of arrays, element i of every array belongs to bubble i
+   */
+  class Band
+  {
+    public:
+      std::vector<double> x;
+      std::vector<double> y;
+      std::vector<double> theta;
+      std::vector<double> expansion;
+
+      /**
+       * @return number of bubbles in the band
+       */
+      int size() const;
+
+      /**
+       * @return true if there are no bubbles in the band
+       */
+      bool empty() const;
+
+      /**
+       * @brief removes all bubbles
+       */
+      void clear();
+
+      /**
+       * @brief reserves memory for a number of bubbles
+       * @param number of bubbles
+       */
+      void reserve(int num_bubbles);
+
+      /**
+       * @param position of bubble in band
+       * @return copy of the bubble
+       */
+      BubbleState get(int bubble_num) const;
+
+      /**
+       * @brief overwrites a bubble
+       * @param position of bubble in band
+       * @param new value of the bubble
+       */
+      void set(int bubble_num, const BubbleState& bubble);
+
+      /**
+       * @brief appends a bubble at the end of the band
+       * @param bubble to append
+       */
+      void push_back(const BubbleState& bubble);
+
+      /**
+       * @brief inserts a bubble before the given position
+       * @param position of bubble before which the new bubble is inserted
+       * @param bubble to insert
+       */
+      void insert(int bubble_num, const BubbleState& bubble);
+
+      /**
+       * @brief inserts bubbles of another band before the given position
+       * @param position of bubble before which the new bubbles are inserted
+       * @param band from which bubbles are copied
+       * @param position of first bubble to copy
+       * @param position after the last bubble to copy
+       */
+      void insert(int bubble_num, const Band& other, int first, int last);
+
+      /**
+       * @brief removes the bubbles in the intervall [first, last)
+       * @param position of first bubble to remove
+       * @param position after the last bubble to remove
+       */
+      void erase(int first, int last);
+  };
+
+  /**
+   * @class LinkedBand
+   * @brief Elastic band stored as doubly linked list over a pool of bubbles, used while bubbles are removed and inserted
+   * during refinement. Bubbles are referred to by handles, which stay valid while other bubbles are removed or inserted,
+   * and removing or inserting a bubble does not move any other bubble. Handles of removed bubbles are reused
+   */
+  class LinkedBand
+  {
+    public:
+      /**
+       * @return number of bubbles in the band
+       */
+      int size() const;
+
+      /**
+       * @brief removes all bubbles, the memory of the pool is kept
+       */
+      void clear();
+
+      /**
+       * @brief replaces the bubbles by the bubbles of a band, the handle of each bubble is its position in the band
+       * @param band from which bubbles are copied
+       */
+      void assign(const Band& band);
+
+      /**
+       * @brief copies the bubbles in the order of the list into a band
+       * @param band to which bubbles are copied
+       */
+      void copyTo(Band& band) const;
+
+      /**
+       * @return true if bubbles were inserted or removed since the band was assigned or cleared
+       */
+      bool modified() const;
+
+      /**
+       * @return handle of the first bubble, -1 if the band is empty
+       */
+      int front() const;
+
+      /**
+       * @return handle of the last bubble, -1 if the band is empty
+       */
+      int back() const;
+
+      /**
+       * @param handle of a bubble
+       * @return handle of the following bubble, -1 if it is the last one
+       */
+      int next(int handle) const;
+
+      /**
+       * @param handle of a bubble
+       * @return handle of the preceding bubble, -1 if it is the first one
+       */
+      int prev(int handle) const;
+
+      /**
+       * @param handle of a bubble
+       * @return the bubble
+       */
+      const BubbleState& get(int handle) const;
+
+      /**
+       * @brief appends a bubble at the end of the band
+       * @param bubble to append
+       * @return handle of the new bubble
+       */
+      int push_back(const BubbleState& bubble);
+
+      /**
+       * @brief inserts a bubble before another one
+       * @param handle of bubble before which the new bubble is inserted
+       * @param bubble to insert
+       * @return handle of the new bubble
+       */
+      int insert(int handle, const BubbleState& bubble);
+
+      /**
+       * @brief removes the bubbles from first up to last, following the list
+       * @param handle of first bubble to remove
+       * @param handle of the bubble after the last bubble to remove, -1 to remove up to the end
+       */
+      void erase(int first, int last);
+
+    private:
+      struct Node
+      {
+        BubbleState bubble;
+        int prev;
+        int next;
+      };
+
+      std::vector<Node> nodes_; // pool of bubbles, in no particular order
+      std::vector<int> free_; // handles of removed bubbles in the pool
+      int front_ = -1, back_ = -1, size_ = 0;
+      bool modified_ = false;
+
+      /**
+       * @brief takes a node from the pool for a new bubble, the node is not linked yet
+       * @param bubble to store
+       * @return handle of the node
+       */
+      int allocate(const BubbleState& bubble);
+  };
+
   enum AddAtPosition {add_front, add_back};
 
   // functions
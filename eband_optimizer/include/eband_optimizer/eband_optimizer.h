@@ -53,6 +53,7 @@
 
 #include <voronoi_msgs_and_types/map.h>
 #include <voronoi_msgs_and_types/graph_node.h>
+#include <voronoi_msgs_and_types/distance_field.h>
 
 // msgs
 #include <nav_msgs/Path.h>
@@ -81,7 +82,7 @@ namespace eband_optimizer{
   class EBandOptimizer{
 
     public:
-      Map* map_;
+      const Map* map_; // only read, so that optimizers on several threads can share a map
 
       /**
        * @brief Default constructor
@@ -92,7 +93,7 @@ namespace eband_optimizer{
        * @brief Constructs the elastic band object
        * @param map The cost map to use for assigning costs to trajectories
        */
-      EBandOptimizer(Map* map);
+      EBandOptimizer(const Map* map);
 
       /**
        * @brief  Destructor
@@ -103,7 +104,19 @@ namespace eband_optimizer{
        * @brief Initializes the elastic band class by accesing costmap and loading parameters
        * @param map The cost map to use for assigning costs to trajectories
        */
-      void initialize(Map* map);
+      void initialize(const Map* map);
+
+      /**
+       * @brief Sets the distance field from which bubble expansions and external forces are calculated. The field has to be computed for the map the plan is optimized in, otherwise distances are recovered from the cost of the map
+       * @param pointer to distance field in cells, nullptr to always use the cost of the map
+       */
+      void setDistanceField(const DistanceField* distance_field);
+
+      /**
+       * @brief Sets the number of threads jacobi_update_ may use to move the bubbles of a band
+       * @param max_threads maximum number of threads, 0 for one per hardware thread. With 1 bubbles are moved on the calling thread
+       */
+      void setMaxThreads(int max_threads);
 
       // /**
       //  * @brief Reconfigures the parameters of the planner
@@ -122,7 +135,15 @@ namespace eband_optimizer{
        * @param global_plan The plan which shall be optimized
        * @return True if the plan was set successfully
        */
-      bool setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, Map* map);
+      bool setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, const Map* map);
+
+      /**
+       * @brief Set plan which shall be optimized, starting from a band optimized for the same path before. The band is connected to the start of the plan and its bubbles behind the start are dropped, at the goal it is extended along the plan or cut. Only the new parts of the band and bubbles whose expansion changed in the map are optimized afterwards
+       * @param global_plan The plan which shall be optimized, it has to follow the band up to where the band ends
+       * @param warm_band band optimized for the same path before, in the same frame as the plan
+       * @return True if the plan was set successfully, false if the plan does not follow the band, or the band can not be connected to start and goal or is in collision
+       */
+      bool setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, const Map* map, const Band& warm_band);
 
       /**
        * @brief This transforms the refined band to a path again and outputs it
@@ -138,6 +159,25 @@ namespace eband_optimizer{
        */
       bool getBand(std::vector<Bubble>& elastic_band);
 
+      /**
+       * @brief This outputs the elastic_band in the internal representation, which can be used to warm start a later plan
+       * @param reference via which the band is passed to the caller
+       * @return true if there was a band to pass
+       */
+      bool getBand(Band& elastic_band);
+
+      /**
+       * @brief Number of optimization cycles the last optimization ran, the largest over both parts of a warm started band
+       * @return number of cycles, at most num_optim_iterations_
+       */
+      int getNumIterations() const;
+
+      /**
+       * @brief Largest force on a bubble in the last cycle of the last optimization, used to check for convergence
+       * @return absolute value of the force
+       */
+      double getResidual() const;
+
       /**
        * @brief converts robot_pose to a bubble and tries to connect to the path
        * @param pose of the robot which shall be connected to the band
@@ -169,19 +209,72 @@ namespace eband_optimizer{
       double equilibrium_relative_overshoot_ = 0.75; ///@brief percentage of old force for which a new force is considered significant when higher as this value
       double significant_force_ = 0.15; ///@brief lower bound for absolute value of force below which it is treated as insignificant (no recursive approximation)
       double costmap_weight_ = 10.0; // the costmap weight or scaling factor
+      bool jacobi_update_ = false; ///<@brief compute the forces on all bubbles from the band of the last iteration and move them independently (on several threads for long bands), instead of moving one bubble after another
+      bool converge_on_residual_ = false; ///<@brief stop moving bubbles once the force on them falls below significant_force_ until a neighbour moves, and stop the optimization once no bubble moves any more
 
     private:
       // flags
-      bool initialized_, visualization_ = false;
+      bool initialized_ = false, visualization_ = false;
 
       // data
       std::vector<geometry_msgs::Point> footprint_spec_; // specification of robot footprint as vector of corner points
-      std::vector<geometry_msgs::PoseStamped> global_plan_; // copy of the plan that shall be optimized
-      std::vector<Bubble> elastic_band_;
+      const DistanceField* distance_field_ = nullptr; // distance to obstacles, computed once per map update by the owner
+      int max_threads_ = 0; // maximum number of threads moving bubbles in modifyBandJacobi, 0 for one per hardware thread
+      std_msgs::Header plan_header_; // header of the plan that shall be optimized, handed back with the optimized plan
+      Band elastic_band_;
+      int fixed_first_ = -1, fixed_last_ = -1; // range of bubbles of a warm started band which are left out of optimization, -1 if none
+      int num_iterations_ = 0; // number of cycles the last optimization ran
+      double residual_ = 0.0; // largest force on a bubble in the last cycle of the last optimization
+
+      // buffers reused between optimization cycles, so that modifying the band does not allocate memory
+      std::vector<Force2D> internal_forces_, external_forces_, forces_; // forces acting on every bubble of the band
+      LinkedBand refined_band_; // band which is refined by refineBand, or whose gap is filled by addFrames
+      LinkedBand gap_band_; // moved bubble and its neighbour, used to check whether the gap between them can be filled
+      Band moved_band_; // band with all bubbles moved at once, used by modifyBandJacobi
+      Band window_band_; // part of a warm started band which is optimized
+      std::vector<double> residuals_; // absolute value of the force on every bubble of the band in the current cycle
+      std::vector<char> active_, refined_active_; // whether bubbles are moved in the next cycle, used with converge_on_residual_
+      Band unrefined_band_; // band before refinement, used to carry over which bubbles are active
 
 
       // methods
 
+      /**
+       * @brief cycles over the elastic band checks it for validity and optimizes it locally by minimizing an energy-function
+       * @param reference to band which shall be optimized
+       * @return true if band is valid
+       */
+      bool optimizeBand(Band& band);
+
+      /**
+       * @brief optimizes a part of elastic_band_, its first and last bubble stay where they are
+       * @param first index of first bubble of the part
+       * @param last index one past the last bubble of the part
+       * @return true if the part is valid
+       */
+      bool optimizeWindow(int first, int last);
+
+      /**
+       * @brief checks whether a plan follows a band, used before a band is warm started. Every frame has to be connected to the closest bubble by a line free of obstacles
+       * @param band which the plan shall follow
+       * @param first bubble of the band which is kept
+       * @param last bubble of the band which is kept
+       * @param plan whose frames are checked
+       * @param start_bubble bubble at the start of the plan, frames inside it are not checked
+       * @param last_frame last frame of the plan which has to follow the band
+       * @return true if every frame from the second up to last_frame follows the band
+       */
+      bool coversPlan(const Band& band, int first, int last, const std::vector<geometry_msgs::PoseStamped>& plan,
+          const BubbleState& start_bubble, int last_frame);
+
+      /**
+       * @brief carries over which bubbles are active from the band before refinement, bubbles next to inserted or removed bubbles become active
+       * @param band before refinement
+       * @param band after refinement
+       * @return true if any bubble is active
+       */
+      bool updateActiveBubbles(const Band& unrefined_band, const Band& band);
+
       // band refinement (filling of gaps & removing redundant bubbles)
 
       /**
@@ -189,27 +282,28 @@ namespace eband_optimizer{
        * @param band is a reference to the band that shall be refined
        * @return true if all gaps could be closed and band is valid
        */
-      bool refineBand(std::vector<Bubble>& band);
+      bool refineBand(Band& band);
 
 
       /**
        * @brief recursively checks an intervall of a band whether gaps need to be filled or bubbles may be removed and fills or removes if possible. This exploits the sequential structure of the band. Therefore it can not detect redundant cycles which are closed over several on its own not redundant bubbles.
        * @param reference to the elastic band that shall be checked
-       * @param reference to the iterator pointing to the start of the intervall that shall be checked
-       * @param reference to the iterator pointing to the end of the intervall that shall be checked
+       * @param handle of the start of the intervall that shall be checked
+       * @param handle of the end of the intervall that shall be checked
+       * @param number of steps from the start to the end of the intervall
        * @return true if segment is valid (all gaps filled), falls if band is broken within this segment
        */		
-      bool removeAndFill(std::vector<Bubble>& band, std::vector<Bubble>::iterator& start_iter,std::vector<Bubble>::iterator& end_iter);
+      bool removeAndFill(LinkedBand& band, int start, int end, int num_steps);
 
 
       /**
        * @brief recursively fills gaps between two bubbles (if possible)
        * @param reference to the elastic band that is worked on
-       * @param reference to the iterator pointing to the start of the intervall that shall be filled
-       * @param reference to the iterator pointing to the end of the intervall that shall be filled
+       * @param handle of the start of the intervall that shall be filled
+       * @param handle of the end of the intervall that shall be filled, following the start
        * @return true if gap was successfully filled otherwise false (band broken)
        */		
-      bool fillGap(std::vector<Bubble>& band, std::vector<Bubble>::iterator& start_iter,std::vector<Bubble>::iterator& end_iter);
+      bool fillGap(LinkedBand& band, int start, int end);
 
 
       // optimization
@@ -219,17 +313,55 @@ namespace eband_optimizer{
        * @param reference to band which shall be modified
        * @return true if band could be modified, all steps finished cleanly
        */
-      bool modifyBandArtificialForce(std::vector<Bubble>& band);
+      bool modifyBandArtificialForce(Band& band);
 
 
       /**
        * @brief Applies forces to move bubbles and recalculates expansion of bubbles
        * @param reference to number of bubble which shall be modified - number might be modified if additional bubbles are introduced to fill band
        * @param reference to band which shall be modified
-       * @param forces and torques which shall be applied
+       * @param force and torque which shall be applied to the bubble
        * @return true if modified band valid, false if band is broken (one or more bubbles in collision) 
        */
-      bool applyForces(int bubble_num, std::vector<Bubble>& band, std::vector<geometry_msgs::WrenchStamped> forces);
+      bool applyForces(int bubble_num, Band& band, const Force2D& force);
+
+
+      /**
+       * @brief Modifies the band like modifyBandArtificialForce, but forces on all bubbles are calculated from the band of the last iteration (Jacobi instead of Gauss-Seidel update), so that bubbles can be moved independently of each other. Bubbles which can not be connected to their neighbours at the new position are moved back afterwards
+       * @param reference to band which shall be modified
+       * @return true if band could be modified, all steps finished cleanly
+       */
+      bool modifyBandJacobi(Band& band);
+
+
+      /**
+       * @brief Calculates forces on and moves the bubbles in [first, last) of a band into moved_band_. Only writes to these bubbles, so can be run for disjoint intervals at the same time
+       * @param band of the last iteration
+       * @param position of the first bubble that shall be moved
+       * @param position after the last bubble that shall be moved
+       * @return true if forces could be calculated for all bubbles
+       */
+      bool moveBubbles(const Band& band, int first, int last);
+
+
+      /**
+       * @brief Moves a bubble by a force and recalculates its expansion, approximating the equilibrium point if the force changes significantly. Does not check the connection to neighbouring bubbles
+       * @param position of the bubble which shall be moved
+       * @param band containing the bubble, not modified
+       * @param force and torque which shall be applied to the bubble
+       * @param reference to hand back the moved bubble
+       * @return true if the bubble may be moved, false if the bubble shall keep its old position
+       */
+      bool moveBubble(int bubble_num, const Band& band, const Force2D& force, BubbleState& new_bubble);
+
+
+      /**
+       * @brief Checks whether two neighbouring bubbles overlap or the gap between them can be filled
+       * @param first bubble
+       * @param second bubble
+       * @return true if the bubbles can be connected
+       */
+      bool checkConnection(const BubbleState& bubble1, const BubbleState& bubble2);
 
 
       /**
@@ -241,60 +373,71 @@ namespace eband_optimizer{
        * @param current recursion depth to constrain number of recurions
        * @return true if recursion successfully
        */
-      bool moveApproximateEquilibrium(const int& bubble_num, const std::vector<Bubble>& band, Bubble& curr_bubble,
-          const geometry_msgs::WrenchStamped& curr_bubble_force, geometry_msgs::Twist& curr_step_width,
-          const int& curr_recursion_depth);
+      bool moveApproximateEquilibrium(const int& bubble_num, const Band& band, BubbleState& curr_bubble,
+          const Force2D& curr_bubble_force, Twist2D& curr_step_width, const int& curr_recursion_depth);
 
 
       // problem (geometry) dependant functions
 
       /**
        * @brief interpolates between two bubbles by calculating the pose for the center of a bubble in the middle of the path connecting the bubbles [depends kinematics]
-       * @param center of first of the two bubbles between which shall be interpolated
-       * @param center of second of the two bubbles between which shall be interpolated
-       * @param reference to hand back the interpolated bubble's center
+       * @param first of the two bubbles between which shall be interpolated
+       * @param second of the two bubbles between which shall be interpolated
+       * @param reference to hand back the interpolated bubble, only the center is set
        * @return true if interpolation was successful
        */
-      bool interpolateBubbles(geometry_msgs::PoseStamped start_center, geometry_msgs::PoseStamped end_center, geometry_msgs::PoseStamped& interpolated_center);
+      bool interpolateBubbles(const BubbleState& start_bubble, const BubbleState& end_bubble, BubbleState& interpolated_bubble);
 
 
       /**
        * @brief this checks whether two bubbles overlap
-       * @param band on which we want to check
-       * @param iterator to first bubble
-       * @param iterator to second bubble
+       * @param first bubble
+       * @param second bubble
        * @return true if bubbles overlap
        */
-      bool checkOverlap(Bubble bubble1, Bubble bubble2);
+      bool checkOverlap(const BubbleState& bubble1, const BubbleState& bubble2);
 
 
       /**
        * @brief This calculates the distance between two bubbles [depends kinematics, shape]
-       * @param pose of the center of first bubbles
-       * @param pose of the center of second bubbles
+       * @param first bubble
+       * @param second bubble
        * @param refernce to variable to pass distance to caller function
        * @return true if distance was successfully calculated
        */
-      bool calcBubbleDistance(geometry_msgs::Pose start_center_pose, geometry_msgs::Pose end_center_pose, double& distance);
+      bool calcBubbleDistance(const BubbleState& start_bubble, const BubbleState& end_bubble, double& distance);
 
 
       /**
        * @brief Calculates the difference between the pose of the center of two bubbles and outputs it as Twist (pointing from first to second bubble) [depends kinematic]
-       * @param pose of the first bubble
-       * @param pose of the second bubble
+       * @param first bubble
+       * @param second bubble
        * @param reference to variable in wich the difference is stored as twist
        * @return true if difference was successfully calculated
        */
-      bool calcBubbleDifference(geometry_msgs::Pose start_center_pose, geometry_msgs::Pose end_center_pose, geometry_msgs::Twist& difference);
+      bool calcBubbleDifference(const BubbleState& start_bubble, const BubbleState& end_bubble, Twist2D& difference);
 
 
       /**
-       * @brief Calculates the distance between the center of a bubble and the closest obstacle [depends kinematics, shape, environment]
-       * @param center of bubble as Pose
+       * @brief Calculates the distance between the center of a bubble and the closest obstacle, from the distance field if one is set, otherwise from the cost of the map [depends kinematics, shape, environment]
+       * @param x coordinate of center of bubble
+       * @param y coordinate of center of bubble
        * @param reference to distance variable
        * @return True if successfully calculated distance false otherwise
        */
-      bool calcObstacleKinematicDistance(geometry_msgs::Pose center_pose, double& distance);
+      bool calcObstacleKinematicDistance(double x, double y, double& distance);
+
+
+      /**
+       * @brief Reads the distance between the center of a bubble and the closest obstacle and its gradient from the distance field [depends kinematics, shape, environment]
+       * @param x coordinate of center of bubble
+       * @param y coordinate of center of bubble
+       * @param reference to distance variable
+       * @param reference to derivative of distance in x-direction
+       * @param reference to derivative of distance in y-direction
+       * @return True if a distance field matching the map is set, false otherwise
+       */
+      bool calcObstacleFieldDistance(double x, double y, double& distance, double& gradient_x, double& gradient_y);
 
 
       /**
@@ -305,7 +448,7 @@ namespace eband_optimizer{
        * @param reference to variable via which forces and torques are given back
        * @return true if forces were calculated successfully
        */
-      bool getForcesAt(int bubble_num, std::vector<Bubble> band, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces);
+      bool getForcesAt(int bubble_num, const Band& band, const BubbleState& curr_bubble, Force2D& forces);
 
 
       /**
@@ -316,7 +459,7 @@ namespace eband_optimizer{
        * @param reference to variable via which forces and torques are given back
        * @return true if forces were calculated successfully
        */
-      bool calcInternalForces(int bubble_num, std::vector<Bubble> band, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces);
+      bool calcInternalForces(int bubble_num, const Band& band, const BubbleState& curr_bubble, Force2D& forces);
 
 
       /**
@@ -326,7 +469,7 @@ namespace eband_optimizer{
        * @param reference to variable via which forces and torques are given back
        * @return true if forces were calculated successfully
        */
-      bool calcExternalForces(int bubble_num, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces);
+      bool calcExternalForces(int bubble_num, const BubbleState& curr_bubble, Force2D& forces);
 
 
       /**
@@ -335,7 +478,7 @@ namespace eband_optimizer{
        * @param reference to variable via which forces and torques are given back
        * @return true if forces were calculated successfully
        */
-      bool suppressTangentialForces(int bubble_num, std::vector<Bubble> band, geometry_msgs::WrenchStamped& forces);
+      bool suppressTangentialForces(int bubble_num, const Band& band, Force2D& forces);
 
 
       // type conversion
@@ -346,16 +489,17 @@ namespace eband_optimizer{
        * @param band is the resulting sequence of bubbles
        * @return true if path was successfully converted - band did not break
        */
-      bool convertPlanToBand(std::vector<geometry_msgs::PoseStamped> plan, std::vector<Bubble>& band);
+      bool convertPlanToBand(const std::vector<geometry_msgs::PoseStamped>& plan, Band& band);
 
 
       /**
        * @brief This converts a band from a sequence of bubbles into a plan from, a sequence of stamped poses
-       * @param band is the sequence of bubbles which shall be converted
        * @param plan is the resulting sequence of stamped Poses
+       * @param band is the sequence of bubbles which shall be converted
+       * @param header is assigned to every pose of the plan
        * @return true if path was successfully converted - band did not break
        */
-      bool convertBandToPlan(std::vector<geometry_msgs::PoseStamped>& plan, std::vector<Bubble> band);
+      bool convertBandToPlan(std::vector<geometry_msgs::PoseStamped>& plan, const Band& band, const std_msgs::Header& header);
 
   };
 };
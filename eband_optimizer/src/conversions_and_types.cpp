@@ -39,6 +39,252 @@
 
 namespace eband_optimizer{
 
+  int Band::size() const
+  {
+    return x.size();
+  }
+
+
+  bool Band::empty() const
+  {
+    return x.empty();
+  }
+
+
+  void Band::clear()
+  {
+    x.clear();
+    y.clear();
+    theta.clear();
+    expansion.clear();
+  }
+
+
+  void Band::reserve(int num_bubbles)
+  {
+    x.reserve(num_bubbles);
+    y.reserve(num_bubbles);
+    theta.reserve(num_bubbles);
+    expansion.reserve(num_bubbles);
+  }
+
+
+  BubbleState Band::get(int bubble_num) const
+  {
+    return BubbleState{x[bubble_num], y[bubble_num], theta[bubble_num], expansion[bubble_num]};
+  }
+
+
+  void Band::set(int bubble_num, const BubbleState& bubble)
+  {
+    x[bubble_num] = bubble.x;
+    y[bubble_num] = bubble.y;
+    theta[bubble_num] = bubble.theta;
+    expansion[bubble_num] = bubble.expansion;
+  }
+
+
+  void Band::push_back(const BubbleState& bubble)
+  {
+    x.push_back(bubble.x);
+    y.push_back(bubble.y);
+    theta.push_back(bubble.theta);
+    expansion.push_back(bubble.expansion);
+  }
+
+
+  void Band::insert(int bubble_num, const BubbleState& bubble)
+  {
+    x.insert(x.begin() + bubble_num, bubble.x);
+    y.insert(y.begin() + bubble_num, bubble.y);
+    theta.insert(theta.begin() + bubble_num, bubble.theta);
+    expansion.insert(expansion.begin() + bubble_num, bubble.expansion);
+  }
+
+
+  void Band::insert(int bubble_num, const Band& other, int first, int last)
+  {
+    x.insert(x.begin() + bubble_num, other.x.begin() + first, other.x.begin() + last);
+    y.insert(y.begin() + bubble_num, other.y.begin() + first, other.y.begin() + last);
+    theta.insert(theta.begin() + bubble_num, other.theta.begin() + first, other.theta.begin() + last);
+    expansion.insert(expansion.begin() + bubble_num, other.expansion.begin() + first, other.expansion.begin() + last);
+  }
+
+
+  void Band::erase(int first, int last)
+  {
+    x.erase(x.begin() + first, x.begin() + last);
+    y.erase(y.begin() + first, y.begin() + last);
+    theta.erase(theta.begin() + first, theta.begin() + last);
+    expansion.erase(expansion.begin() + first, expansion.begin() + last);
+  }
+
+
+  int LinkedBand::size() const
+  {
+    return size_;
+  }
+
+
+  void LinkedBand::clear()
+  {
+    nodes_.clear();
+    free_.clear();
+    front_ = -1;
+    back_ = -1;
+    size_ = 0;
+    modified_ = false;
+  }
+
+
+  void LinkedBand::assign(const Band& band)
+  {
+    free_.clear();
+    modified_ = false;
+    size_ = band.size();
+    nodes_.resize(size_);
+    for(int i = 0; i < size_; i++)
+    {
+      Node& node = nodes_[i];
+      node.bubble = BubbleState{band.x[i], band.y[i], band.theta[i], band.expansion[i]};
+      node.prev = i - 1;
+      node.next = i + 1;
+    }
+
+    front_ = size_ > 0 ? 0 : -1;
+    back_ = size_ - 1;
+    if(size_ > 0)
+      nodes_[back_].next = -1;
+  }
+
+
+  void LinkedBand::copyTo(Band& band) const
+  {
+    band.x.resize(size_);
+    band.y.resize(size_);
+    band.theta.resize(size_);
+    band.expansion.resize(size_);
+    int i = 0;
+    for(int handle = front_; handle >= 0; handle = nodes_[handle].next, i++)
+    {
+      const BubbleState& bubble = nodes_[handle].bubble;
+      band.x[i] = bubble.x;
+      band.y[i] = bubble.y;
+      band.theta[i] = bubble.theta;
+      band.expansion[i] = bubble.expansion;
+    }
+  }
+
+
+  bool LinkedBand::modified() const
+  {
+    return modified_;
+  }
+
+
+  int LinkedBand::front() const
+  {
+    return front_;
+  }
+
+
+  int LinkedBand::back() const
+  {
+    return back_;
+  }
+
+
+  int LinkedBand::next(int handle) const
+  {
+    return nodes_[handle].next;
+  }
+
+
+  int LinkedBand::prev(int handle) const
+  {
+    return nodes_[handle].prev;
+  }
+
+
+  const BubbleState& LinkedBand::get(int handle) const
+  {
+    return nodes_[handle].bubble;
+  }
+
+
+  int LinkedBand::push_back(const BubbleState& bubble)
+  {
+    int handle = allocate(bubble);
+    nodes_[handle].prev = back_;
+    nodes_[handle].next = -1;
+    if(back_ >= 0)
+      nodes_[back_].next = handle;
+    else
+      front_ = handle;
+
+    back_ = handle;
+    size_++;
+    modified_ = true;
+    return handle;
+  }
+
+
+  int LinkedBand::insert(int handle, const BubbleState& bubble)
+  {
+    int new_handle = allocate(bubble);
+    int prev_handle = nodes_[handle].prev;
+    nodes_[new_handle].prev = prev_handle;
+    nodes_[new_handle].next = handle;
+    nodes_[handle].prev = new_handle;
+    if(prev_handle >= 0)
+      nodes_[prev_handle].next = new_handle;
+    else
+      front_ = new_handle;
+
+    size_++;
+    modified_ = true;
+    return new_handle;
+  }
+
+
+  void LinkedBand::erase(int first, int last)
+  {
+    int prev_handle = nodes_[first].prev;
+    for(int i = first; i != last; i = nodes_[i].next)
+    {
+      free_.push_back(i);
+      size_--;
+    }
+
+    if(prev_handle >= 0)
+      nodes_[prev_handle].next = last;
+    else
+      front_ = last;
+
+    if(last >= 0)
+      nodes_[last].prev = prev_handle;
+    else
+      back_ = prev_handle;
+
+    modified_ = true;
+  }
+
+
+  int LinkedBand::allocate(const BubbleState& bubble)
+  {
+    if(!free_.empty())
+    {
+      int handle = free_.back();
+      free_.pop_back();
+      nodes_[handle].bubble = bubble;
+      return handle;
+    }
+
+    nodes_.push_back(Node{bubble, -1, -1});
+    return nodes_.size() - 1;
+  }
+
+
   void PoseToPose2D(const geometry_msgs::Pose pose, geometry_msgs::Pose2D& pose2D)
   {
     // use tf-pkg to convert angles
@@ -37,6 +37,11 @@
 
 #include <eband_optimizer/eband_optimizer.h>
 
+#include <algorithm>
+#include <future>
+#include <limits>
+#include <thread>
+
 
 namespace eband_optimizer{
 
@@ -44,7 +49,7 @@ namespace eband_optimizer{
   EBandOptimizer::EBandOptimizer() : initialized_(false) {}
 
 
-  EBandOptimizer::EBandOptimizer(Map* map)
+  EBandOptimizer::EBandOptimizer(const Map* map)
   {
     // initialize planner
     initialize(map);
@@ -56,7 +61,7 @@ namespace eband_optimizer{
   }
 
 
-  void EBandOptimizer::initialize(Map* map)
+  void EBandOptimizer::initialize(const Map* map)
   {
     // check if the plugin is already initialized
     if(!initialized_)
@@ -91,6 +96,16 @@ namespace eband_optimizer{
     }
   }
 
+  void EBandOptimizer::setDistanceField(const DistanceField* distance_field)
+  {
+    distance_field_ = distance_field;
+  }
+
+  void EBandOptimizer::setMaxThreads(int max_threads)
+  {
+    max_threads_ = max_threads;
+  }
+
   // void EBandOptimizer::reconfigure(
   //   eband_local_planner::EBandPlannerConfig& config)
   // {
@@ -123,10 +138,12 @@ namespace eband_optimizer{
   // }
 
 
-  bool EBandOptimizer::setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, Map* map)
+  bool EBandOptimizer::setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, const Map* map)
   {
     map_ = map;
     elastic_band_.clear();
+    fixed_first_ = -1;
+    fixed_last_ = -1;
 
     // // check if plugin initialized
     if(!initialized_)
@@ -141,8 +158,8 @@ namespace eband_optimizer{
       ROS_ERROR("Attempt to pass empty path to optimization. Valid path needs to have at least 2 Frames. This one has %d.", ((int) global_plan.size()) );
       return false;
     }
-    // copy plan to local member variable
-    global_plan_ = global_plan;
+    // keep header of plan, it is handed back with the optimized plan
+    plan_header_ = global_plan.front().header;
 
     // check whether plan and costmap are in the same frame
     if(global_plan.front().header.frame_id != map_->frame_id)
@@ -154,7 +171,7 @@ namespace eband_optimizer{
 
     // convert frames in path into bubbles in band -> sets center of bubbles and calculates expansion
     ROS_DEBUG("Converting Plan to Band");
-    if(!convertPlanToBand(global_plan_, elastic_band_))
+    if(!convertPlanToBand(global_plan, elastic_band_))
     {
       ROS_WARN("Conversion from plan to elastic band failed. Plan probably not collision free. Plan not set for optimization");
       // TODO try to do local repairs of band
@@ -175,6 +192,258 @@ namespace eband_optimizer{
   }
 
 
+  bool EBandOptimizer::setPlan(const std::vector<geometry_msgs::PoseStamped>& global_plan, const Map* map, const Band& warm_band)
+  {
+    // number of unchanged bubbles next to the changed parts of the band which are optimized with them
+    const int num_margin_bubbles = 5;
+
+    map_ = map;
+    elastic_band_.clear();
+    fixed_first_ = -1;
+    fixed_last_ = -1;
+
+    // check if plugin initialized
+    if(!initialized_)
+    {
+      ROS_ERROR("This planner has not been initialized, please call initialize() before using this planner");
+      return false;
+    }
+
+    // check if plan and band valid (minimum 2 frames)
+    if(global_plan.size() < 2 || warm_band.size() < 2)
+    {
+      ROS_DEBUG("Plan or band for warm start too short. Plan has %d frames, band has %d.", ((int) global_plan.size()), warm_band.size());
+      return false;
+    }
+
+    // keep header of plan, it is handed back with the optimized plan
+    plan_header_ = global_plan.front().header;
+
+    // check whether plan and costmap are in the same frame
+    if(global_plan.front().header.frame_id != map_->frame_id)
+    {
+      ROS_ERROR("Elastic Band expects plan for optimization in the %s frame, the plan was sent in the %s frame.",
+          map_->frame_id.c_str(), global_plan.front().header.frame_id.c_str());
+      return false;
+    }
+
+    // map might have changed since the band was optimized -> recalculate expansions and remember which bubbles changed
+    Band band = warm_band;
+    std::vector<bool> unchanged(band.size());
+    for(int i = 0; i < band.size(); i++)
+    {
+      double distance;
+      if(!calcObstacleKinematicDistance(band.x[i], band.y[i], distance) || distance <= tiny_bubble_expansion_)
+      {
+        ROS_DEBUG("Bubble %d of band for warm start in collision. No warm start.", i);
+        return false;
+      }
+
+      unchanged[i] = fabs(distance - band.expansion[i]) <= tiny_bubble_expansion_;
+      band.expansion[i] = distance;
+    }
+
+    // start of plan connects to the bubble furthest along the band which overlaps it, or else to the closest bubble.
+    // Bubbles behind it are dropped
+    Band start_band, end_band;
+    std::vector<geometry_msgs::PoseStamped> frames(1, global_plan.front());
+    if(!convertPlanToBand(frames, start_band))
+    {
+      ROS_DEBUG("Start of plan in collision. No warm start.");
+      return false;
+    }
+
+    int first = -1;
+    for(int i = band.size() - 1; i >= 0 && first < 0; i--)
+    {
+      if(checkOverlap(start_band.get(0), band.get(i)))
+        first = i;
+    }
+
+    if(first < 0)
+    {
+      double min_distance = std::numeric_limits<double>::max();
+      for(int i = 0; i < band.size(); i++)
+      {
+        double distance = hypot(start_band.x[0] - band.x[i], start_band.y[0] - band.y[i]);
+        if(distance < min_distance)
+        {
+          min_distance = distance;
+          first = i;
+        }
+      }
+    }
+
+    // end of plan - the band either ends at the goal already, is extended along the plan or is cut at the goal
+    int last = band.size() - 1;
+    int last_covered_frame = global_plan.size() - 1;
+    const geometry_msgs::Point& goal = global_plan.back().pose.position;
+    if(hypot(goal.x - band.x[last], goal.y - band.y[last]) > map_->resolution)
+    {
+      // frame of plan closest to the end of the band
+      int closest = 0;
+      double min_distance = std::numeric_limits<double>::max();
+      for(int i = 0; i < global_plan.size(); i++)
+      {
+        double distance = hypot(global_plan[i].pose.position.x - band.x[last], global_plan[i].pose.position.y - band.y[last]);
+        if(distance < min_distance)
+        {
+          min_distance = distance;
+          closest = i;
+        }
+      }
+
+      bool extend = closest < global_plan.size() - 1 && min_distance <= band.expansion[last];
+      if(extend)
+        frames.assign(global_plan.begin() + closest + 1, global_plan.end());
+      else
+        frames.assign(1, global_plan.back());
+
+      last_covered_frame = extend ? closest : global_plan.size() - 2;
+
+      if(!convertPlanToBand(frames, end_band))
+      {
+        ROS_DEBUG("End of plan in collision. No warm start.");
+        return false;
+      }
+
+      // goal lies on the band - connect it to the first bubble after the start which overlaps it
+      if(!extend)
+      {
+        last = -1;
+        for(int i = first; i < band.size() && last < 0; i++)
+        {
+          if(checkOverlap(band.get(i), end_band.get(0)))
+            last = i;
+        }
+
+        if(last < 0)
+        {
+          ROS_DEBUG("Goal of plan is not on the band. No warm start.");
+          return false;
+        }
+      }
+    }
+
+    // the plan has to follow the kept bubbles, otherwise the band leads around obstacles on another side than the plan
+    // (the middle of the plan is replaced by the band)
+    if(!coversPlan(band, first, last, global_plan, start_band.get(0), last_covered_frame))
+    {
+      ROS_DEBUG("Plan does not follow the band. No warm start.");
+      return false;
+    }
+
+    // compose band of start, the kept bubbles and the end, then close gaps and remove redundant bubbles
+    elastic_band_ = start_band;
+    elastic_band_.insert(elastic_band_.size(), band, first, last + 1);
+    elastic_band_.insert(elastic_band_.size(), end_band, 0, end_band.size());
+    if(!refineBand(elastic_band_))
+    {
+      ROS_DEBUG("Could not connect plan to band. No warm start.");
+      elastic_band_.clear();
+      return false;
+    }
+
+    // find the bubbles which were kept as they were, refining might have removed some at the ends of the kept part
+    int kept_start = -1, warm_start = -1;
+    for(int i = 0; i < elastic_band_.size() && kept_start < 0; i++)
+    {
+      for(int j = first; j <= last; j++)
+      {
+        if(elastic_band_.x[i] == band.x[j] && elastic_band_.y[i] == band.y[j])
+        {
+          kept_start = i;
+          warm_start = j;
+          break;
+        }
+      }
+    }
+
+    if(kept_start < 0)
+    {
+      ROS_DEBUG("Band warm started - all %d bubbles are optimized.", elastic_band_.size());
+      return true;
+    }
+
+    int num_kept = 0;
+    while(kept_start + num_kept < elastic_band_.size() && warm_start + num_kept <= last &&
+        elastic_band_.x[kept_start + num_kept] == band.x[warm_start + num_kept] &&
+        elastic_band_.y[kept_start + num_kept] == band.y[warm_start + num_kept])
+      num_kept++;
+
+    // longest run of kept bubbles whose expansion did not change
+    int run_first = 0, run_length = 0;
+    for(int i = 0; i < num_kept; i++)
+    {
+      int length = 0;
+      while(i + length < num_kept && unchanged[warm_start + i + length])
+        length++;
+
+      if(length > run_length)
+      {
+        run_first = i;
+        run_length = length;
+      }
+
+      i += length;
+    }
+
+    // leave the run out of optimization except for a margin next to the changed parts, the goal is fixed anyway.
+    // The first and last fixed bubble connect the optimized parts to the rest of the band
+    int fixed_first = kept_start + run_first + num_margin_bubbles;
+    int fixed_last = kept_start + run_first + run_length - 1;
+    if(fixed_last < elastic_band_.size() - 1)
+      fixed_last -= num_margin_bubbles;
+
+    if(run_length > 0 && fixed_first <= fixed_last)
+    {
+      fixed_first_ = fixed_first;
+      fixed_last_ = fixed_last;
+    }
+
+    ROS_DEBUG("Band warm started - %d of %d bubbles are not optimized.", fixed_first_ < 0 ? 0 : fixed_last_ - fixed_first_ + 1,
+        elastic_band_.size());
+    return true;
+  }
+
+
+  bool EBandOptimizer::coversPlan(const Band& band, int first, int last, const std::vector<geometry_msgs::PoseStamped>& plan,
+      const BubbleState& start_bubble, int last_frame)
+  {
+    // frames of the plan and bubbles of the band are in the same order -> the closest bubble of every frame is searched
+    // from the closest bubble of the frame before. If every frame can be moved onto its bubble along a free straight
+    // line, band and plan lead around obstacles on the same side
+    int bubble_num = first;
+    for(int i = 1; i <= last_frame; i++)
+    {
+      const geometry_msgs::Point& position = plan[i].pose.position;
+      if(hypot(position.x - start_bubble.x, position.y - start_bubble.y) <= start_bubble.expansion)
+        continue;
+
+      while(bubble_num < last && hypot(position.x - band.x[bubble_num + 1], position.y - band.y[bubble_num + 1]) <=
+          hypot(position.x - band.x[bubble_num], position.y - band.y[bubble_num]))
+        bubble_num++;
+
+      double dx = band.x[bubble_num] - position.x;
+      double dy = band.y[bubble_num] - position.y;
+      double length = hypot(dx, dy);
+      if(length <= band.expansion[bubble_num])
+        continue;
+
+      // step along the line by the distance to the closest obstacle
+      double distance;
+      for(double step = 0.0; step < length; step += distance)
+      {
+        if(!calcObstacleKinematicDistance(position.x + dx * step / length, position.y + dy * step / length, distance) ||
+            distance <= tiny_bubble_expansion_)
+          return false;
+      }
+    }
+
+    return true;
+  }
+
+
   bool EBandOptimizer::getPlan(std::vector<geometry_msgs::PoseStamped>& global_plan)
   {
     // check if plugin initialized
@@ -192,7 +461,7 @@ namespace eband_optimizer{
     }
 
     // convert band to plan
-    if(!convertBandToPlan(global_plan, elastic_band_))
+    if(!convertBandToPlan(global_plan, elastic_band_, plan_header_))
     {
       ROS_WARN("Conversion from Elastic Band to path failed.");
       return false;
@@ -211,7 +480,35 @@ namespace eband_optimizer{
       return false;
     }
 
-    elastic_band = elastic_band_;
+    // convert to bubbles with stamped centers
+    std::vector<geometry_msgs::PoseStamped> centers;
+    convertBandToPlan(centers, elastic_band_, plan_header_);
+    elastic_band.resize(elastic_band_.size());
+    for(int i = 0; i < elastic_band_.size(); i++)
+    {
+      elastic_band[i].center = centers[i];
+      elastic_band[i].expansion = elastic_band_.expansion[i];
+    }
+
+    // check if there is a band
+    if(elastic_band_.empty())
+    {
+      ROS_WARN("Band is empty.");
+      return false;
+    }
+
+    return true;
+  }
+
+
+  bool EBandOptimizer::getBand(Band& elastic_band)
+  {
+    // check if plugin initialized
+    if(!initialized_)
+    {
+      ROS_ERROR("This planner has not been initialized, please call initialize() before using this planner");
+      return false;
+    }
 
     // check if there is a band
     if(elastic_band_.empty())
@@ -220,10 +517,23 @@ namespace eband_optimizer{
       return false;
     }
 
+    elastic_band = elastic_band_;
     return true;
   }
 
 
+  int EBandOptimizer::getNumIterations() const
+  {
+    return num_iterations_;
+  }
+
+
+  double EBandOptimizer::getResidual() const
+  {
+    return residual_;
+  }
+
+
   bool EBandOptimizer::addFrames(const std::vector<geometry_msgs::PoseStamped>& plan_to_add, const AddAtPosition& add_frames_at)
   {
     // check if plugin initialized
@@ -257,7 +567,7 @@ namespace eband_optimizer{
 
 
     // convert plan to band
-    std::vector<Bubble> band_to_add;
+    Band band_to_add;
     if(!convertPlanToBand(plan_to_add, band_to_add))
     {
       ROS_DEBUG("Conversion from plan to elastic band failed. Plan not appended");
@@ -274,10 +584,10 @@ namespace eband_optimizer{
     {
       // add frames at the front of the current band
       // - for instance to connect band and current robot position
-      for(int i = ((int) elastic_band_.size() - 1); i >= 0; i--)
+      for(int i = (elastic_band_.size() - 1); i >= 0; i--)
       {
         // cycle over bubbles from End - connect to bubble furthest away but overlapping
-        if(checkOverlap(band_to_add.back(), elastic_band_.at(i)))
+        if(checkOverlap(band_to_add.get(band_to_add.size() - 1), elastic_band_.get(i)))
         {
           bubble_connect = i;
           connected = true;
@@ -289,10 +599,10 @@ namespace eband_optimizer{
     {
       // add frames at the end of the current band
       // - for instance to connect new frames entering the moving window
-      for(int i = 0; i < ((int) elastic_band_.size() - 1); i++)
+      for(int i = 0; i < (elastic_band_.size() - 1); i++)
       {
         // cycle over bubbles from Start - connect to bubble furthest away but overlapping
-        if(checkOverlap(band_to_add.front(), elastic_band_.at(i)))
+        if(checkOverlap(band_to_add.get(0), elastic_band_.get(i)))
         {
           bubble_connect = i;
           connected = true;
@@ -302,10 +612,10 @@ namespace eband_optimizer{
     }
 
     // intanstiate local copy of band
-    std::vector<Bubble> tmp_band;
-    std::vector<Bubble>::iterator tmp_iter1, tmp_iter2;
+    Band tmp_band;
+    int tmp_num1, tmp_num2;
     // copy new frames to tmp_band
-    tmp_band.assign(band_to_add.begin(), band_to_add.end());
+    tmp_band = band_to_add;
 
     if(connected)
     {
@@ -313,16 +623,16 @@ namespace eband_optimizer{
       if(add_frames_at == add_front)
       {
         // compose new vector by appending elastic_band to new frames
-        tmp_iter1 = elastic_band_.begin() + bubble_connect;
-        ROS_ASSERT( (tmp_iter1 >= elastic_band_.begin()) && (tmp_iter1 < elastic_band_.end()) );
-        tmp_band.insert(tmp_band.end(), tmp_iter1, elastic_band_.end());
+        tmp_num1 = bubble_connect;
+        ROS_ASSERT( (tmp_num1 >= 0) && (tmp_num1 < elastic_band_.size()) );
+        tmp_band.insert(tmp_band.size(), elastic_band_, tmp_num1, elastic_band_.size());
       }
       else
       {
         // compose new vector by pre-appending elastic_band to new frames
-        tmp_iter1 = elastic_band_.begin() + bubble_connect + 1; // +1 - as insert only appends [start, end)
-        ROS_ASSERT( (tmp_iter1 > elastic_band_.begin()) && (tmp_iter1 <= elastic_band_.end()) );
-        tmp_band.insert(tmp_band.begin(), elastic_band_.begin(), tmp_iter1);
+        tmp_num1 = bubble_connect + 1; // +1 - as insert only appends [start, end)
+        ROS_ASSERT( (tmp_num1 > 0) && (tmp_num1 <= elastic_band_.size()) );
+        tmp_band.insert(0, elastic_band_, 0, tmp_num1);
       }
 
       // done
@@ -335,25 +645,27 @@ namespace eband_optimizer{
     if(add_frames_at == add_front)
     {
       // compose new vector by appending elastic_band to new frames
-      tmp_band.insert(tmp_band.end(), elastic_band_.begin(), elastic_band_.end());
-      // and get iterators to connecting bubbles
-      tmp_iter1 = tmp_band.begin() + ((int) band_to_add.size()) - 1;
-      tmp_iter2 = tmp_iter1 + 1;
+      tmp_band.insert(tmp_band.size(), elastic_band_, 0, elastic_band_.size());
+      // and get positions of connecting bubbles
+      tmp_num1 = band_to_add.size() - 1;
+      tmp_num2 = tmp_num1 + 1;
     }
     else
     {
       // compose new vector by pre-appending elastic_band to new frames
-      tmp_band.insert(tmp_band.begin(), elastic_band_.begin(), elastic_band_.end());
-      // and get iterators to connecting bubbles
-      tmp_iter1 = tmp_band.begin() + ((int) elastic_band_.size()) - 1;
-      tmp_iter2 = tmp_iter1 + 1;
+      tmp_band.insert(0, elastic_band_, 0, elastic_band_.size());
+      // and get positions of connecting bubbles
+      tmp_num1 = elastic_band_.size() - 1;
+      tmp_num2 = tmp_num1 + 1;
     }
 
     // just in case
-    ROS_ASSERT( tmp_iter1 >= tmp_band.begin() );
-    ROS_ASSERT( tmp_iter2 < tmp_band.end() );
-    ROS_ASSERT( tmp_iter1 < tmp_iter2 );
-    if(!fillGap(tmp_band, tmp_iter1, tmp_iter2))
+    ROS_ASSERT( tmp_num1 >= 0 );
+    ROS_ASSERT( tmp_num2 < tmp_band.size() );
+    ROS_ASSERT( tmp_num1 < tmp_num2 );
+    // handles of the linked band are the positions in tmp_band
+    refined_band_.assign(tmp_band);
+    if(!fillGap(refined_band_, tmp_num1, tmp_num2))
     {
       // we could not connect band and robot at its current position
       ROS_DEBUG("Could not connect robot pose to band - Failed to fill gap.");
@@ -361,7 +673,7 @@ namespace eband_optimizer{
     }
 
     // otherwise - done
-    elastic_band_ = tmp_band;
+    refined_band_.copyTo(elastic_band_);
 
     return true;
   }
@@ -385,7 +697,20 @@ namespace eband_optimizer{
 
     // call optimization with member elastic_band_
     ROS_DEBUG("Starting optimization of band");
-    if(!optimizeBand(elastic_band_))
+    num_iterations_ = 0;
+    residual_ = 0.0;
+    if(fixed_first_ >= 0)
+    {
+      // warm started band - only the parts in front of and behind the fixed bubbles are optimized, the back part first
+      // so that the indices of the front part stay valid
+      if((fixed_last_ < elastic_band_.size() - 1 && !optimizeWindow(fixed_last_, elastic_band_.size())) ||
+          !optimizeWindow(0, fixed_first_ + 1))
+      {
+        ROS_DEBUG("Aborting Optimization. Changes discarded.");
+        return false;
+      }
+    }
+    else if(!optimizeBand(elastic_band_))
     {
       ROS_DEBUG("Aborting Optimization. Changes discarded.");
       return false;
@@ -396,6 +721,19 @@ namespace eband_optimizer{
   }
 
 
+  bool EBandOptimizer::optimizeWindow(int first, int last)
+  {
+    window_band_.clear();
+    window_band_.insert(0, elastic_band_, first, last);
+    if(!optimizeBand(window_band_))
+      return false;
+
+    elastic_band_.erase(first, last);
+    elastic_band_.insert(first, window_band_, 0, window_band_.size());
+    return true;
+  }
+
+
   bool EBandOptimizer::optimizeBand(std::vector<Bubble>& band)
   {
     // check if plugin initialized
@@ -413,14 +751,47 @@ namespace eband_optimizer{
       return false;
     }
 
-    double distance;
+    // convert to internal representation, expansions are recalculated during optimization
+    Band tmp_band;
+    geometry_msgs::Pose2D center_pose2D;
+    tmp_band.reserve(band.size());
     for(int i = 0; i < ((int) band.size()); i++)
+    {
+      PoseToPose2D(band[i].center.pose, center_pose2D);
+      tmp_band.push_back(BubbleState{center_pose2D.x, center_pose2D.y, center_pose2D.theta, band[i].expansion});
+    }
+
+    num_iterations_ = 0;
+    residual_ = 0.0;
+    if(!optimizeBand(tmp_band))
+      return false;
+
+    // and convert back
+    std::vector<geometry_msgs::PoseStamped> centers;
+    convertBandToPlan(centers, tmp_band, band.front().center.header);
+    band.resize(tmp_band.size());
+    for(int i = 0; i < tmp_band.size(); i++)
+    {
+      band[i].center = centers[i];
+      band[i].expansion = tmp_band.expansion[i];
+    }
+
+    return true;
+  }
+
+
+  // private methods
+
+  bool EBandOptimizer::optimizeBand(Band& band)
+  {
+    double distance;
+    for(int i = 0; i < band.size(); i++)
     {
       // update Size of Bubbles in band by calculating Dist to nearest Obstacle [depends kinematic, environment]
-      if(!calcObstacleKinematicDistance(band.at(i).center.pose, distance))
+      if(!calcObstacleKinematicDistance(band.x[i], band.y[i], distance))
       {
         ROS_DEBUG("Optimization (Elastic Band) - Calculation of Distance failed. Frame %d of %d Probably outside map coordinates.",
-            i, ((int) band.size()) );
+            i, band.size() );
         return false;
       }
 
@@ -428,12 +799,12 @@ namespace eband_optimizer{
       {
         // frame must not be immediately in collision -> otherwise calculation of gradient will later be invalid
         ROS_DEBUG("Optimization (Elastic Band) - Calculation of Distance failed. Frame %d of %d in collision. Plan invalid. Trying to refine band.",
-            i, ((int) band.size()) );
+            i, band.size() );
         // TODO if frame in collision try to repair band instead of aborting everything
         return false;
       }
 
-      band.at(i).expansion = distance;
+      band.expansion[i] = distance;
     }
 
     // close gaps and remove redundant bubbles
@@ -444,12 +815,16 @@ namespace eband_optimizer{
     }
 
     // get a copy of current (valid) band
-    std::vector<Bubble> tmp_band = band;
+    Band tmp_band = band;
+    active_.assign(tmp_band.size(), true);
 
     // now optimize iteratively (for instance by miminizing the energy-function of the full system)
-    for(int i = 0; i < num_optim_iterations_; i++)
+    int num_iterations = 0;
+    double residual = 0.0;
+    while(num_iterations < num_optim_iterations_)
     {
-      ROS_DEBUG("Inside optimization: Cycle no %d", i);
+      ROS_DEBUG("Inside optimization: Cycle no %d", num_iterations);
+      num_iterations++;
 
       // calculate forces and apply changes
       if(!modifyBandArtificialForce(tmp_band))
@@ -459,6 +834,14 @@ namespace eband_optimizer{
         return false;
       }
 
+      // largest force on a bubble in this cycle, bubbles left out of the cycle count as 0
+      residual = 0.0;
+      for(int i = 0; i < residuals_.size(); i++)
+        residual = std::max(residual, residuals_[i]);
+
+      if(converge_on_residual_)
+        unrefined_band_ = tmp_band;
+
       // check whether band still valid - refine if neccesarry
       if(!refineBand(tmp_band))
       {
@@ -466,17 +849,72 @@ namespace eband_optimizer{
         // modified band is not valid anymore -> discard changes and stop process
         return false;
       }
+
+      // stop once all bubbles converged
+      if(converge_on_residual_ && !updateActiveBubbles(unrefined_band_, tmp_band))
+      {
+        ROS_DEBUG("Optimization converged after %d cycles, largest force %f", num_iterations, residual);
+        break;
+      }
     }
 
+    num_iterations_ = std::max(num_iterations_, num_iterations);
+    residual_ = std::max(residual_, residual);
+
     // copy changes back to band
     band = tmp_band;
     return true;
   }
 
 
-  // private methods
+  bool EBandOptimizer::updateActiveBubbles(const Band& unrefined_band, const Band& band)
+  {
+    // bubbles which can be removed before a kept bubble when searching for it in the unrefined band
+    const int max_removed_bubbles = 8;
+
+    // refining only removes and inserts bubbles -> kept bubbles are found in the same order in the unrefined band.
+    // Inserted bubbles and bubbles next to inserted or removed ones are active
+    refined_active_.assign(band.size(), true);
+    int j = 0;
+    bool inserted = false;
+    for(int i = 0; i < band.size(); i++)
+    {
+      int kept = -1;
+      for(int k = j; k < unrefined_band.size() && k <= j + max_removed_bubbles && kept < 0; k++)
+      {
+        if(unrefined_band.x[k] == band.x[i] && unrefined_band.y[k] == band.y[i] && unrefined_band.theta[k] == band.theta[i])
+          kept = k;
+      }
+
+      if(kept < 0)
+      {
+        // inserted bubble
+        if(i > 0)
+          refined_active_[i - 1] = true;
+
+        inserted = true;
+        continue;
+      }
+
+      // bubbles were removed in front of this one
+      if(kept > j && i > 0)
+        refined_active_[i - 1] = true;
+
+      refined_active_[i] = active_[kept] || kept > j || inserted;
+      inserted = false;
+      j = kept + 1;
+    }
+
+    active_.swap(refined_active_);
+    bool any_active = false;
+    for(int i = 1; i < band.size() - 1; i++)
+      any_active = any_active || active_[i];
+
+    return any_active;
+  }
+
 
-  bool EBandOptimizer::refineBand(std::vector<Bubble>& band)
+  bool EBandOptimizer::refineBand(Band& band)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -488,21 +926,14 @@ namespace eband_optimizer{
     // check if band valid (minimum 2 bubbles)
     if(band.size() < 2)
     {
-      ROS_WARN("Attempt to convert empty band to plan. Valid band needs to have at least 2 Frames. This one has %d.", ((int) band.size()) );
+      ROS_WARN("Attempt to convert empty band to plan. Valid band needs to have at least 2 Frames. This one has %d.", band.size() );
       return false;
     }
 
-    // instantiate local variables
-    bool success;
-    std::vector<Bubble> tmp_band;
-    std::vector<Bubble>::iterator start_iter, end_iter;
-
-    // remove redundant Bubbles and fill gabs recursively
-    tmp_band = band;
-    start_iter = tmp_band.begin();
-    end_iter = (tmp_band.end() - 1); // -1 because .end() points "past the end"!
-
-    success = removeAndFill(tmp_band, start_iter, end_iter);
+    // remove redundant Bubbles and fill gabs recursively, work on a linked copy in a member to reuse its memory, so
+    // that removing and inserting bubbles does not move the rest of the band
+    refined_band_.assign(band);
+    bool success = removeAndFill(refined_band_, refined_band_.front(), refined_band_.back(), refined_band_.size() - 1);
 
     if(!success)
       ROS_DEBUG("Band is broken. Could not close gaps.");
@@ -511,36 +942,28 @@ namespace eband_optimizer{
 #ifdef DEBUG_EBAND_
       ROS_DEBUG("Recursive filling and removing DONE");
 #endif
-      band = tmp_band;
+      // bubbles of the band itself are not changed by refinement, so it is only copied back if bubbles were added or removed
+      if(refined_band_.modified())
+        refined_band_.copyTo(band);
     }
 
     return success;
   }
 
 
-  bool EBandOptimizer::removeAndFill(std::vector<Bubble>& band, std::vector<Bubble>::iterator& start_iter,std::vector<Bubble>::iterator& end_iter)
+  bool EBandOptimizer::removeAndFill(LinkedBand& band, int start, int end, int num_steps)
   {
-    // instantiate local variables
-    bool overlap;
-    std::vector<Bubble>::iterator tmp_iter;
-    int mid_int, diff_int;
-
 #ifdef DEBUG_EBAND_
-    int debug_dist_start, debug_dist_iters;
-    debug_dist_start = std::distance(band.begin(), start_iter);
-    debug_dist_iters = std::distance(start_iter, end_iter);
-    ROS_DEBUG("Refining Recursive - Check if Bubbles %d and %d overlapp. Total size of band %d.", debug_dist_start, (debug_dist_start + debug_dist_iters), ((int) band.size()) );
+    ROS_DEBUG("Refining Recursive - Check if Bubbles %d and %d overlapp. Total size of band %d.", start, end, band.size() );
 #endif
 
-    // check that iterators are still valid
-    ROS_ASSERT( start_iter >= band.begin() );
-    ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-    ROS_ASSERT( start_iter < end_iter );
+    // check that positions are still valid
+    ROS_ASSERT( start >= 0 );
+    ROS_ASSERT( end >= 0 );
+    ROS_ASSERT( num_steps > 0 );
 
     // check whether start and end bubbles of this intervall overlap
-    overlap = checkOverlap(*start_iter, *end_iter);
-
-    if(overlap)
+    if(checkOverlap(band.get(start), band.get(end)))
     {
 
 #ifdef DEBUG_EBAND_
@@ -548,17 +971,14 @@ namespace eband_optimizer{
 #endif
 
       // if there are bubbles between start and end of intervall remove them (they are redundant as start and end of intervall do overlap)
-      if((start_iter + 1) < end_iter)
+      if(num_steps > 1)
       {
 #ifdef DEBUG_EBAND_
-        ROS_DEBUG("Refining Recursive - Bubbles overlapp, removing Bubbles %d to %d.", (debug_dist_start + 1), (debug_dist_start + debug_dist_iters -1));
+        ROS_DEBUG("Refining Recursive - Bubbles overlapp, removing %d Bubbles after bubble %d.", num_steps - 1, start);
 #endif
 
-        // erase bubbles between start and end (but not start and end themself) and get new iterator to end (old one is invalid)
-        tmp_iter = band.erase((start_iter+1), end_iter);
-
-        // write back changed iterator pointing to the end of the intervall
-        end_iter = tmp_iter;
+        // erase bubbles between start and end (but not start and end themself)
+        band.erase(band.next(start), end);
       }
 
 #ifdef DEBUG_EBAND_
@@ -571,86 +991,49 @@ namespace eband_optimizer{
 
 
     // if bubbles do not overlap -> check whether there are still bubbles between start and end
-    if((start_iter + 1) < end_iter)
+    if(num_steps > 1)
     {
 #ifdef DEBUG_EBAND_
       ROS_DEBUG("Refining Recursive - Bubbles do not overlapp, go one recursion deeper");
 #endif
 
       // split remaining sequence of bubbles
-      // get distance between start and end iterator for this intervall
-      mid_int = std::distance(start_iter, end_iter);
-      mid_int = mid_int/2; // division by integer implies floor (round down)
-
-      // now get iterator pointing to the middle (roughly)
-      tmp_iter = start_iter + mid_int;
-      // and realative position of end_iter to tmp_iter
-      diff_int = (int) std::distance(tmp_iter, end_iter);
-
-      // after all this arithmetics - check that iterators are still valid
-      ROS_ASSERT( start_iter >= band.begin() );
-      ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-      ROS_ASSERT( start_iter < end_iter );
-
+      // get the middle (roughly), division by integer implies floor (round down)
+      int mid_steps = num_steps/2;
+      int mid = start;
+      for(int i = 0; i < mid_steps; i++)
+        mid = band.next(mid);
 
       // and call removeAndFill recursively for the left intervall
-      if(!removeAndFill(band, start_iter, tmp_iter))
+      if(!removeAndFill(band, start, mid, mid_steps))
       {
         // band is broken in this intervall and could not be fixed
         return false;
       }
 
-      // carefull at this point!!! if we filled in or removed bubbles end_iter is not valid anymore
-      // but the relative position towards tmp_iter is still the same and tmp_iter was kept valid in the lower recursion steps
-      end_iter = tmp_iter + diff_int;
-
-      // check that iterators are still valid - one more time
-      ROS_ASSERT( start_iter >= band.begin() );
-      ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-      ROS_ASSERT( (start_iter < tmp_iter) && (tmp_iter < end_iter) );
-
-
       // o.k. we are done with left hand intervall now do the same for the right hand intervall
-      // but first get relative position of start and tmp iter
-      diff_int = (int) std::distance(start_iter, tmp_iter);
-      if(!removeAndFill(band, tmp_iter, end_iter))
+      // (bubbles inserted or removed in the left intervall do not move any other bubble, so mid and end stay valid)
+      if(!removeAndFill(band, mid, end, num_steps - mid_steps))
       {
         // band is broken in this intervall and could not be fixed
         return false;
       }
 
-      // if we filled in bubbles vector might have been reallocated -> start_iter might be invalid
-      start_iter = tmp_iter - diff_int;
-
-      // check that iterators are still valid - almost done
-      ROS_ASSERT( start_iter >= band.begin() );
-      ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-      ROS_ASSERT( (start_iter < tmp_iter) && (tmp_iter < end_iter) );
-
 
       // we reached the leaf but we are not yet done
       // -> we know that there are no redundant elements in the left intervall taken on its own
       // -> and we know the same holds for the right intervall
       // but the middle bubble itself might be redundant -> check it
-      if(checkOverlap(*(tmp_iter-1), *(tmp_iter+1)))
+      if(checkOverlap(band.get(band.prev(mid)), band.get(band.next(mid))))
       {
 #ifdef DEBUG_EBAND_
         ROS_DEBUG("Refining Recursive - Removing middle bubble");
 #endif
 
-        // again: get distance between (tmp_iter + 1) and end_iter, (+1 because we will erase tmp_iter itself)
-        diff_int = (int) std::distance((tmp_iter + 1), end_iter);
-
-        // remove middle bubble and correct end_iter
-        tmp_iter = band.erase(tmp_iter);
-        end_iter = tmp_iter + diff_int;
+        // remove middle bubble
+        band.erase(mid, band.next(mid));
       }
 
-      // check that iterators are still valid - almost almost
-      ROS_ASSERT( start_iter >= band.begin() );
-      ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-      ROS_ASSERT( start_iter < end_iter );
-
 #ifdef DEBUG_EBAND_
       ROS_DEBUG("Refining Recursive - Bubbles do not overlapp, go one recursion deeper DONE");
 #endif
@@ -665,10 +1048,10 @@ namespace eband_optimizer{
 #endif
 
     // last possible case -> bubbles do not overlap AND there are nor bubbles in between -> try to fill gap recursively
-    if(!fillGap(band, start_iter, end_iter))
+    if(!fillGap(band, start, end))
     {
       // band is broken in this intervall and could not be fixed (this should only be called on a leaf, so we put a log_out here;)
-      ROS_DEBUG("Failed to fill gap between bubble %d and %d.", (int) distance(band.begin(), start_iter), (int) distance(band.begin(), end_iter) );
+      ROS_DEBUG("Failed to fill gap between bubble %d and %d.", start, end );
       return false;
     }
 
@@ -681,22 +1064,19 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::fillGap(std::vector<Bubble>& band, std::vector<Bubble>::iterator& start_iter,std::vector<Bubble>::iterator& end_iter)
+  bool EBandOptimizer::fillGap(LinkedBand& band, int start, int end)
   {
     // insert bubbles in the middle between not-overlapping bubbles (e.g. (Dist > Size Bub1) && (Dist > Size Bub2) )
     // repeat until gaps are closed
 
     // instantiate local variables
     double distance = 0.0;
-    Bubble interpolated_bubble;
-    geometry_msgs::PoseStamped interpolated_center;
-    std::vector<Bubble>::iterator tmp_iter;
-    int diff_int, start_num, end_num;
+    BubbleState interpolated_bubble;
 
     // make sure this method was called for a valid element in the forces or bubbles vector
-    ROS_ASSERT( start_iter >= band.begin() );
-    ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-    ROS_ASSERT( start_iter < end_iter );
+    ROS_ASSERT( start >= 0 );
+    ROS_ASSERT( end >= 0 );
+    ROS_ASSERT( band.next(start) == end );
 
 
 #ifdef DEBUG_EBAND_
@@ -704,12 +1084,10 @@ namespace eband_optimizer{
 #endif
 
     // interpolate between bubbles [depends kinematic]
-    if(!interpolateBubbles(start_iter->center, end_iter->center, interpolated_center))
+    if(!interpolateBubbles(band.get(start), band.get(end), interpolated_bubble))
     {
       // interpolation failed (for whatever reason), so return with false
-      start_num = std::distance(band.begin(), start_iter);
-      end_num = std::distance(band.begin(), end_iter);
-      ROS_DEBUG("Interpolation failed while trying to fill gap between bubble %d and %d.", start_num, end_num);
+      ROS_DEBUG("Interpolation failed while trying to fill gap between bubble %d and %d.", start, end);
       return false;
     }
 
@@ -719,43 +1097,29 @@ namespace eband_optimizer{
 #endif
 
     // calc Size of Bubbles by calculating Dist to nearest Obstacle [depends kinematic, environment]
-    if(!calcObstacleKinematicDistance(interpolated_center.pose, distance))
+    if(!calcObstacleKinematicDistance(interpolated_bubble.x, interpolated_bubble.y, distance))
     {
       // pose probably outside map coordinates
-      start_num = std::distance(band.begin(), start_iter);
-      end_num = std::distance(band.begin(), end_iter);
-      ROS_DEBUG("Calculation of Distance failed for interpolated bubble - failed to fill gap between bubble %d and %d.", start_num, end_num);
+      ROS_DEBUG("Calculation of Distance failed for interpolated bubble - failed to fill gap between bubble %d and %d.", start, end);
       return false;
     }
 
     if(distance <= tiny_bubble_expansion_)
     {
       // band broken! frame must not be immediately in collision -> otherwise calculation of gradient will later be invalid
-      start_num = std::distance(band.begin(), start_iter);
-      end_num = std::distance(band.begin(), end_iter);
-      ROS_DEBUG("Interpolated Bubble in Collision - failed to fill gap between bubble %d and %d.", start_num, end_num);
+      ROS_DEBUG("Interpolated Bubble in Collision - failed to fill gap between bubble %d and %d.", start, end);
       // TODO this means only that there is an obstacle on the direct interconnection between the bubbles - think about repair or rescue strategies -
       return false;
     }
 
 
 #ifdef DEBUG_EBAND_
-    ROS_DEBUG("Fill recursive - inserting interpolated bubble at (%f, %f), with expansion %f", interpolated_center.pose.position.x, interpolated_center.pose.position.y, distance);
+    ROS_DEBUG("Fill recursive - inserting interpolated bubble at (%f, %f), with expansion %f", interpolated_bubble.x, interpolated_bubble.y, distance);
 #endif
 
-    // insert bubble and assign center and expansion
-    interpolated_bubble.center = interpolated_center;
+    // insert bubble and assign expansion, start and end stay valid
     interpolated_bubble.expansion = distance;
-    // insert bubble (vector.insert() inserts elements before given iterator) and get iterator pointing to it
-    tmp_iter = band.insert(end_iter, interpolated_bubble);
-    // insert is a little bit more tricky than erase, as it may require reallocation of the vector -> start and end iter could be invalid
-    start_iter = tmp_iter - 1;
-    end_iter = tmp_iter + 1;
-
-    // check that iterators are still valid - just in case :)
-    ROS_ASSERT( start_iter >= band.begin() );
-    ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-    ROS_ASSERT( (start_iter < tmp_iter) && (tmp_iter < end_iter) );
+    int mid = band.insert(end, interpolated_bubble);
 
 
 #ifdef DEBUG_EBAND_
@@ -763,7 +1127,7 @@ namespace eband_optimizer{
 #endif
 
     // we have now two intervalls (left and right of inserted bubble) which need to be checked again and filled if neccessary
-    if(!checkOverlap(*start_iter, *tmp_iter))
+    if(!checkOverlap(band.get(start), band.get(mid)))
     {
 
 #ifdef DEBUG_EBAND
@@ -771,63 +1135,46 @@ namespace eband_optimizer{
 #endif
 
       // gap in left intervall -> try to fill
-      if(!fillGap(band, start_iter, tmp_iter))
+      if(!fillGap(band, start, mid))
       {
         // band is broken in this intervall and could not be fixed
         return false;
       }
-      // bubbles were inserted -> make sure to keep end_iter iterator valid
-      end_iter = tmp_iter + 1;
     }
 
-    // check that iterators are still valid - just in case :)
-    ROS_ASSERT( start_iter >= band.begin() );
-    ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-    ROS_ASSERT( (start_iter < tmp_iter) && (tmp_iter < end_iter) );
-
 
 #ifdef DEBUG_EBAND_
     ROS_DEBUG("Fill recursive - check overlap interpolated bubble and second bubble");
 #endif
 
-    if(!checkOverlap(*tmp_iter, *end_iter))
+    if(!checkOverlap(band.get(mid), band.get(end)))
     {
 
 #ifdef DEBUG_EBAND_
       ROS_DEBUG("Fill recursive - gap btw. interpolated and second bubble - fill recursive");
 #endif
 
-      // get distance between start_iter and tmp_iter before filling right intervall (in case of reallocation of vector)
-      diff_int = (int) std::distance(start_iter, tmp_iter);
-
-      // gap in left intervall -> try to fill
-      if(!fillGap(band, tmp_iter, end_iter))
+      // gap in right intervall -> try to fill
+      if(!fillGap(band, mid, end))
       {
         // band is broken in this intervall and could not be fixed
         return false;
       }
-      // bubbles were inserted -> make sure to keep start_iter iterator valid
-      start_iter = tmp_iter - diff_int;
     }
 
-    // check that iterators are still valid - just in case :)
-    ROS_ASSERT( start_iter >= band.begin() );
-    ROS_ASSERT( end_iter < band.end() ); // "<" because .end() points _behind_ last element of vector
-    ROS_ASSERT( (start_iter < tmp_iter) && (tmp_iter < end_iter) );
-
 
 #ifdef DEBUG_EBAND_
     ROS_DEBUG("Fill recursive - gap closed");
 #endif
 
-    // bubbles overlap, iterators are kept valid -> done
+    // bubbles overlap -> done
     return true;
   }
 
 
   // optimization
 
-  bool EBandOptimizer::modifyBandArtificialForce(std::vector<Bubble>& band)
+  bool EBandOptimizer::modifyBandArtificialForce(Band& band)
   {
     if(band.empty())
     {
@@ -835,33 +1182,20 @@ namespace eband_optimizer{
       return false;
     }
 
+    residuals_.assign(band.size(), 0.0);
     if(band.size() <= 2)
     {
       // nothing to do here -> we can stop right away
       return true;
     }
 
-    std::vector<geometry_msgs::WrenchStamped> internal_forces, external_forces, forces;
-    geometry_msgs::WrenchStamped wrench;
+    if(jacobi_update_)
+      return modifyBandJacobi(band);
 
-#ifdef DEBUG_EBAND_
-    //publish original band
-    if(visualization_)
-      eband_visual_->publishBand("bubbles", band);
-#endif
-
-    // init variables to calm down debug warnings
-    wrench.header.stamp = ros::Time::now();
-    wrench.header.frame_id = band[0].center.header.frame_id;
-    wrench.wrench.force.x = 0.0;
-    wrench.wrench.force.y = 0.0;
-    wrench.wrench.force.z = 0.0;
-    wrench.wrench.torque.x = 0.0;
-    wrench.wrench.torque.y = 0.0;
-    wrench.wrench.torque.z = 0.0;
-    internal_forces.assign(band.size(), wrench);
-    external_forces = internal_forces;
-    forces = internal_forces;
+    // reset force buffers, memory is only allocated if the band grew
+    internal_forces_.assign(band.size(), Force2D());
+    external_forces_.assign(band.size(), Force2D());
+    forces_.assign(band.size(), Force2D());
 
     // TODO log timigs of planner
     // instantiate variables for timing
@@ -872,8 +1206,34 @@ namespace eband_optimizer{
     // due to refinement band might change its size -> use while loop
     int i = 1;
     bool forward = true; // cycle 1xforwards and 1xbackwards through band
-    while( (i>0) && (i < ((int) band.size() - 1)) )
+    auto next_bubble = [&]()
+    {
+      if(forward)
+      {
+        i++;
+        if(i == (band.size() - 1))
+        {
+          // reached end of band - start backwards cycle until at start again - then stop
+          forward = false;
+          i--;
+          ROS_DEBUG("Optimization Elastic Band - Forward cycle done, starting backward cycle");
+        }
+      }
+      else
+      {
+        i--;
+      }
+    };
+
+    while( (i>0) && (i < (band.size() - 1)) )
     {
+      if(converge_on_residual_ && !active_[i])
+      {
+        // converged bubble - left out until one of its neighbours moves
+        next_bubble();
+        continue;
+      }
+
       ROS_DEBUG("Modifying bubble %d.", i);
 
 
@@ -881,7 +1241,7 @@ namespace eband_optimizer{
       ROS_DEBUG("Calculating internal force for bubble %d.", i);
 #endif
 
-      if(!calcInternalForces(i, band, band.at(i), internal_forces.at(i)))
+      if(!calcInternalForces(i, band, band.get(i), internal_forces_[i]))
       {
         // calculation of internal forces failed - stopping optimization
         ROS_DEBUG("Calculation of internal forces failed");
@@ -889,16 +1249,11 @@ namespace eband_optimizer{
       }
 
 #ifdef DEBUG_EBAND_
-      if(visualization_)
-        // publish internal forces
-        eband_visual_->publishForce("internal_forces", i, eband_visual_->blue, internal_forces[i], band[i]);
-      // Log out debug info about next step
       ROS_DEBUG("Calculating external force for bubble %d.", i);
 #endif
 
 
-      //if(!calcExternalForces(i, band, external_forces))
-      if(!calcExternalForces(i, band.at(i), external_forces.at(i)))
+      if(!calcExternalForces(i, band.get(i), external_forces_[i]))
       {
         // calculation of External Forces failed - stopping optimization
         ROS_DEBUG("Calculation of external forces failed");
@@ -906,83 +1261,176 @@ namespace eband_optimizer{
       }
 
 #ifdef DEBUG_EBAND_
-      if(visualization_)
-        //publish external forces
-        eband_visual_->publishForce("external_forces", i, eband_visual_->red, external_forces[i], band[i]);
-      // Log out debug info about next step
       ROS_DEBUG("Superposing internal and external forces");
 #endif
 
 
       // sum up external and internal forces over all bubbles
-      forces.at(i).wrench.force.x = internal_forces.at(i).wrench.force.x + external_forces.at(i).wrench.force.x;
-      forces.at(i).wrench.force.y = internal_forces.at(i).wrench.force.y + external_forces.at(i).wrench.force.y;
-      forces.at(i).wrench.force.z = internal_forces.at(i).wrench.force.z + external_forces.at(i).wrench.force.z;
-
-      forces.at(i).wrench.torque.x = internal_forces.at(i).wrench.torque.x + external_forces.at(i).wrench.torque.x;
-      forces.at(i).wrench.torque.y = internal_forces.at(i).wrench.torque.y + external_forces.at(i).wrench.torque.y;
-      forces.at(i).wrench.torque.z = internal_forces.at(i).wrench.torque.z + external_forces.at(i).wrench.torque.z;
+      forces_[i].x = internal_forces_[i].x + external_forces_[i].x;
+      forces_[i].y = internal_forces_[i].y + external_forces_[i].y;
+      forces_[i].torque = internal_forces_[i].torque + external_forces_[i].torque;
 
 #ifdef DEBUG_EBAND_
-      ROS_DEBUG("Superpose forces: (x, y, theta) = (%f, %f, %f)", forces.at(i).wrench.force.x, forces.at(i).wrench.force.y, forces.at(i).wrench.torque.z);
+      ROS_DEBUG("Superpose forces: (x, y, theta) = (%f, %f, %f)", forces_[i].x, forces_[i].y, forces_[i].torque);
       ROS_DEBUG("Supressing tangential forces");
 #endif
 
-      if(!suppressTangentialForces(i, band, forces.at(i)))
+      if(!suppressTangentialForces(i, band, forces_[i]))
       {
         // suppression of tangential forces failed
         ROS_DEBUG("Supression of tangential forces failed");
         return false;
       }
 
-#ifdef DEBUG_EBAND_
-      if(visualization_)
-        //publish resulting forces
-        eband_visual_->publishForce("resulting_forces", i, eband_visual_->green, forces[i], band[i]);
-#endif
+
+      residuals_[i] = hypot(hypot(forces_[i].x, forces_[i].y), forces_[i].torque);
+      if(converge_on_residual_ && residuals_[i] < significant_force_)
+      {
+        // converged - bubble is not moved any more until one of its neighbours moves
+        active_[i] = false;
+        next_bubble();
+        continue;
+      }
 
 
       ROS_DEBUG("Applying forces to modify band");
-      if(!applyForces(i, band, forces))
+      double old_x = band.x[i], old_y = band.y[i], old_theta = band.theta[i];
+      if(!applyForces(i, band, forces_[i]))
       {
         // band invalid
         ROS_DEBUG("Band is invalid - Stopping Modification");
         return false;
       }
 
-#ifdef DEBUG_EBAND_
-      if(visualization_)
+      // forces on the neighbours changed with the moved bubble. A bubble which could not be moved would not move again
+      // until one of its neighbours moves
+      if(converge_on_residual_ && (band.x[i] != old_x || band.y[i] != old_y || band.theta[i] != old_theta))
       {
-        // publish band with changed bubble at resulting position
-        eband_visual_->publishBand("bubbles", band);
-        ros::Duration(0.01).sleep();
+        active_[i - 1] = true;
+        active_[i + 1] = true;
       }
-#endif
+      else if(converge_on_residual_)
+        active_[i] = false;
 
 
       //next bubble
-      if(forward)
+      next_bubble();
+    }
+
+    return true;
+  }
+
+
+  bool EBandOptimizer::modifyBandJacobi(Band& band)
+  {
+    // bands shorter than this per thread are modified on a single thread, as starting threads takes longer
+    const int min_bubbles_per_thread = 64;
+
+    int num_bubbles = band.size();
+    forces_.assign(num_bubbles, Force2D());
+    moved_band_ = band;
+
+    // forces and new positions only depend on the band of the last iteration -> all bubbles can be moved independently
+    int num_threads = max_threads_ > 0 ? max_threads_ : std::thread::hardware_concurrency();
+    num_threads = std::min(num_threads, (num_bubbles - 2) / min_bubbles_per_thread);
+    bool success = true;
+    if(num_threads > 1)
+    {
+      std::vector<std::future<bool>> futures;
+      int step = (num_bubbles - 2) / num_threads + 1;
+      for(int first = 1; first < num_bubbles - 1; first += step)
       {
-        i++;
-        if(i == ((int) band.size() - 1))
+        int last = std::min(first + step, num_bubbles - 1);
+        futures.push_back(std::async(std::launch::async, &EBandOptimizer::moveBubbles, this, std::cref(band), first, last));
+      }
+
+      for(auto &future : futures)
+        success = future.get() && success;
+    }
+    else
+      success = moveBubbles(band, 1, num_bubbles - 1);
+
+    if(!success)
+      return false;
+
+    // connectivity repair - bubbles that cannot be connected to their neighbour at their new position are moved back
+    // neighbouring bubbles of the band of the last iteration are connected -> moving bubbles back always ends
+    int i = 0;
+    while(i < num_bubbles - 1)
+    {
+      bool moved = moved_band_.x[i] != band.x[i] || moved_band_.y[i] != band.y[i] || moved_band_.theta[i] != band.theta[i] ||
+        moved_band_.x[i + 1] != band.x[i + 1] || moved_band_.y[i + 1] != band.y[i + 1] || moved_band_.theta[i + 1] != band.theta[i + 1];
+
+      if(moved && !checkConnection(moved_band_.get(i), moved_band_.get(i + 1)))
+      {
+        ROS_DEBUG("Bubble %d or %d at new position cannot be connected to neighbour. Discarding changes.", i, i + 1);
+        moved_band_.set(i, band.get(i));
+        moved_band_.set(i + 1, band.get(i + 1));
+
+        // moving back bubble i might disconnect it from bubble i-1
+        i = std::max(i - 1, 0);
+        continue;
+      }
+
+      i++;
+    }
+
+    // only moved bubbles and their neighbours are active in the next cycle, forces on all other bubbles stay the same
+    if(converge_on_residual_)
+    {
+      refined_active_.assign(num_bubbles, false);
+      for(int i = 1; i < num_bubbles - 1; i++)
+      {
+        if(moved_band_.x[i] != band.x[i] || moved_band_.y[i] != band.y[i] || moved_band_.theta[i] != band.theta[i])
         {
-          // reached end of band - start backwards cycle until at start again - then stop
-          forward = false;
-          i--;
-          ROS_DEBUG("Optimization Elastic Band - Forward cycle done, starting backward cycle");
+          refined_active_[i - 1] = true;
+          refined_active_[i] = true;
+          refined_active_[i + 1] = true;
         }
       }
-      else
+
+      active_.swap(refined_active_);
+    }
+
+    band = moved_band_;
+    return true;
+  }
+
+
+  bool EBandOptimizer::moveBubbles(const Band& band, int first, int last)
+  {
+    for(int i = first; i < last; i++)
+    {
+      // converged bubble - left out until one of its neighbours moves
+      if(converge_on_residual_ && !active_[i])
+        continue;
+
+      if(!getForcesAt(i, band, band.get(i), forces_[i]))
       {
-        i--;
+        ROS_DEBUG("Calculation of forces failed");
+        return false;
       }
+
+      // converged bubble - not moved, so it is left out from the next cycle
+      residuals_[i] = hypot(hypot(forces_[i].x, forces_[i].y), forces_[i].torque);
+      if(converge_on_residual_ && residuals_[i] < significant_force_)
+        continue;
+
+      // neighbours move at the same time -> only go half the way, otherwise neighbouring bubbles overshoot and the band oscillates
+      forces_[i].x *= 0.5;
+      forces_[i].y *= 0.5;
+      forces_[i].torque *= 0.5;
+
+      BubbleState new_bubble;
+      if(moveBubble(i, band, forces_[i], new_bubble))
+        moved_band_.set(i, new_bubble);
     }
 
     return true;
   }
 
 
-  bool EBandOptimizer::applyForces(int bubble_num, std::vector<Bubble>& band, std::vector<geometry_msgs::WrenchStamped> forces)
+  bool EBandOptimizer::applyForces(int bubble_num, Band& band, const Force2D& force)
   {
     //cycle over all bubbles except first and last (these are fixed)
     if(band.size() <= 2)
@@ -991,70 +1439,97 @@ namespace eband_optimizer{
       return true;
     }
 
-    geometry_msgs::Pose2D bubble_pose2D, new_bubble_pose2D;
-    geometry_msgs::Pose bubble_pose, new_bubble_pose;
-    geometry_msgs::Twist bubble_jump;
-    Bubble new_bubble = band.at(bubble_num);
-    double distance;
+    BubbleState new_bubble;
+    if(!moveBubble(bubble_num, band, force, new_bubble))
+    {
+      // this bubble must not be changed, but band is still valid -> continue with other bubbles
+      return true;
+    }
+
+
+    // check validity of resulting band (given the moved bubble)
+
+    // check left connection (bubble and bubble-1) and right connection (bubble and bubble +1)
+    if(!checkConnection(band.get(bubble_num - 1), new_bubble) || !checkConnection(new_bubble, band.get(bubble_num + 1)))
+    {
+      ROS_DEBUG("Bubble at new position cannot be connected to neighbour. Discarding changes.");
+      // this bubble must not be changed, but band is still valid -> continue with other bubbles
+      return true;
+    }
+
+
+    // check successful - bubble and band valid apply changes
+
+#ifdef DEBUG_EBAND_
+    ROS_DEBUG("Frame %d of %d: Check successful - bubble and band valid. Applying Changes", bubble_num, band.size() );
+#endif
+
+    band.set(bubble_num, new_bubble);
+
+    return true;
+  }
+
+
+  bool EBandOptimizer::checkConnection(const BubbleState& bubble1, const BubbleState& bubble2)
+  {
+    // check Overlap - if bubbles do not overlap try to fill gap
+    if(checkOverlap(bubble1, bubble2))
+      return true;
 
+    // TODO use this routine not only to check whether gap can be filled but also to fill gap (if possible)
+    // fillGap only works on the bubbles between the two it is called for, so the gap is checked on a band
+    // holding only the two bubbles instead of a copy of the whole band
+    gap_band_.clear();
+    int start = gap_band_.push_back(bubble1);
+    int end = gap_band_.push_back(bubble2);
+    return fillGap(gap_band_, start, end);
+  }
+
+
+  bool EBandOptimizer::moveBubble(int bubble_num, const Band& band, const Force2D& force, BubbleState& new_bubble)
+  {
+    Twist2D bubble_jump;
+    BubbleState bubble = band.get(bubble_num);
+    new_bubble = bubble;
+    double distance;
 
-    // move bubble
-    bubble_pose = band.at(bubble_num).center.pose;
-    PoseToPose2D(bubble_pose, bubble_pose2D);
 
     // move according to bubble_new = bubble_old + alpha*force -> we choose alpha to be the current expansion of the modified bubble
-    bubble_jump.linear.x = band.at(bubble_num).expansion*forces.at(bubble_num).wrench.force.x;
-    bubble_jump.linear.y = band.at(bubble_num).expansion*forces.at(bubble_num).wrench.force.y;
-    bubble_jump.linear.z = 0.0;
-    bubble_jump.angular.x = 0.0;
-    bubble_jump.angular.y = 0.0;
-    bubble_jump.angular.z = band.at(bubble_num).expansion/map_->robot_radius * forces.at(bubble_num).wrench.torque.z;
-    bubble_jump.angular.z = angles::normalize_angle(bubble_jump.angular.z);
-
-    // apply changes to calc tmp bubble position
-    new_bubble_pose2D.x = bubble_pose2D.x + bubble_jump.linear.x;
-    new_bubble_pose2D.y = bubble_pose2D.y + bubble_jump.linear.y;
-    new_bubble_pose2D.theta = bubble_pose2D.theta + bubble_jump.angular.z;
-    new_bubble_pose2D.theta = angles::normalize_angle(new_bubble_pose2D.theta);
+    bubble_jump.x = bubble.expansion*force.x;
+    bubble_jump.y = bubble.expansion*force.y;
+    bubble_jump.theta = bubble.expansion/map_->robot_radius * force.torque;
+    bubble_jump.theta = angles::normalize_angle(bubble_jump.theta);
 
     // apply changes to local copy
-    Pose2DToPose(new_bubble_pose, new_bubble_pose2D);
-    new_bubble.center.pose = new_bubble_pose;
+    new_bubble.x = bubble.x + bubble_jump.x;
+    new_bubble.y = bubble.y + bubble_jump.y;
+    new_bubble.theta = bubble.theta + bubble_jump.theta;
+    new_bubble.theta = angles::normalize_angle(new_bubble.theta);
 
 #ifdef DEBUG_EBAND_
-    ROS_DEBUG("Try moving bubble %d at (%f, %f, %f) by (%f, %f, %f).", bubble_num, bubble_pose2D.x, bubble_pose2D.y, bubble_pose2D.theta,
-        bubble_jump.linear.x, bubble_jump.linear.y, bubble_jump.angular.z);
+    ROS_DEBUG("Try moving bubble %d at (%f, %f, %f) by (%f, %f, %f).", bubble_num, bubble.x, bubble.y, bubble.theta,
+        bubble_jump.x, bubble_jump.y, bubble_jump.theta);
 #endif
 
 
     // check validity of moved bubble
 
     // recalc expansion of bubble -> calc Size of Bubbles by calculating Dist to nearest Obstacle [depends kinematic, environment]
-    if(!calcObstacleKinematicDistance(new_bubble_pose, distance))
+    if(!calcObstacleKinematicDistance(new_bubble.x, new_bubble.y, distance))
     {
-      ROS_DEBUG("Calculation of Distance failed. Frame %d of %d Probably outside map. Discarding Changes", bubble_num, ((int) band.size()) );
-
-#ifdef DEBUG_EBAND_
-      if(visualization_)
-        eband_visual_->publishBubble("bubble_hypo", bubble_num, eband_visual_->red, new_bubble);
-#endif
+      ROS_DEBUG("Calculation of Distance failed. Frame %d of %d Probably outside map. Discarding Changes", bubble_num, band.size() );
 
       // this bubble must not be changed, but band is still valid -> continue with other bubbles
-      return true;
+      return false;
     }
 
     if(distance <= tiny_bubble_expansion_)
     {
       // frame must not be immediately in collision -> otherwise calculation of gradient will later be invalid
-      ROS_DEBUG("Calculation of Distance failed. Frame %d of %d in collision. Plan invalid. Discarding Changes", bubble_num, ((int) band.size()) );
-
-#ifdef DEBUG_EBAND_
-      if(visualization_)
-        eband_visual_->publishBubble("bubble_hypo", bubble_num, eband_visual_->red, new_bubble);
-#endif
+      ROS_DEBUG("Calculation of Distance failed. Frame %d of %d in collision. Plan invalid. Discarding Changes", bubble_num, band.size() );
 
       // this bubble must not be changed, but band is still valid -> continue with other bubbles
-      return true;
+      return false;
     }
 
     // so far o.k. -> assign distance to new bubble
@@ -1063,14 +1538,14 @@ namespace eband_optimizer{
 
     // check whether step was reasonable
 
-    geometry_msgs::WrenchStamped new_bubble_force = forces.at(bubble_num);
+    Force2D new_bubble_force = force;
 
     // check whether we get a valid force calculation here
     if(!getForcesAt(bubble_num, band, new_bubble, new_bubble_force))
     {
       // error during calculation of forces for the new position - discard changes
       ROS_DEBUG("Cannot calculate forces on bubble %d at new position - discarding changes", bubble_num);
-      return true;
+      return false;
     }
 
 #ifdef DEBUG_EBAND_
@@ -1081,21 +1556,21 @@ namespace eband_optimizer{
     double checksum_zero, abs_new_force, abs_old_force;
 
     // project force-vectors onto each other
-    checksum_zero = (new_bubble_force.wrench.force.x * forces.at(bubble_num).wrench.force.x) +
-      (new_bubble_force.wrench.force.y * forces.at(bubble_num).wrench.force.y) +
-      (new_bubble_force.wrench.torque.z * forces.at(bubble_num).wrench.torque.z);
+    checksum_zero = (new_bubble_force.x * force.x) +
+      (new_bubble_force.y * force.y) +
+      (new_bubble_force.torque * force.torque);
 
     // if sign changes and ...
     if(checksum_zero < 0.0)
     {
       ROS_DEBUG("Detected zero-crossings in force on bubble %d. Checking total change in force.", bubble_num);
       // check the absolute values of the two vectors
-      abs_new_force = sqrt( (new_bubble_force.wrench.force.x * new_bubble_force.wrench.force.x) +
-          (new_bubble_force.wrench.force.y * new_bubble_force.wrench.force.y) +
-          (new_bubble_force.wrench.torque.z * new_bubble_force.wrench.torque.z) );
-      abs_old_force = sqrt( (forces.at(bubble_num).wrench.force.x * forces.at(bubble_num).wrench.force.x) +
-          (forces.at(bubble_num).wrench.force.x * forces.at(bubble_num).wrench.force.x) +
-          (forces.at(bubble_num).wrench.torque.z * forces.at(bubble_num).wrench.torque.z) );
+      abs_new_force = sqrt( (new_bubble_force.x * new_bubble_force.x) +
+          (new_bubble_force.y * new_bubble_force.y) +
+          (new_bubble_force.torque * new_bubble_force.torque) );
+      abs_old_force = sqrt( (force.x * force.x) +
+          (force.y * force.y) +
+          (force.torque * force.torque) );
 
       // force still has a significant high value (> ~75% of old force by default)
       if( (abs_new_force > equilibrium_relative_overshoot_ * abs_old_force) && (abs_new_force > significant_force_) )
@@ -1103,17 +1578,14 @@ namespace eband_optimizer{
         ROS_DEBUG("Detected significante change in force (%f to %f) on bubble %d. Entering Recursive Approximation.", abs_old_force, abs_new_force, bubble_num);
         // o.k. now we really have to take a closer look -> start recursive approximation to equilibrium-point
         int curr_recursion_depth = 0;
-        geometry_msgs::Twist new_step_width;
-        Bubble curr_bubble = band.at(bubble_num);
-        geometry_msgs::WrenchStamped curr_bubble_force = forces.at(bubble_num);
+        Twist2D new_step_width;
+        BubbleState curr_bubble = bubble;
+        Force2D curr_bubble_force = force;
 
         // half step size
-        new_step_width.linear.x = 0.5*bubble_jump.linear.x;
-        new_step_width.linear.y = 0.5*bubble_jump.linear.y;
-        new_step_width.linear.z = 0.5*bubble_jump.linear.z;
-        new_step_width.angular.x = 0.5*bubble_jump.angular.x;
-        new_step_width.angular.y = 0.5*bubble_jump.angular.y;
-        new_step_width.angular.z = 0.5*bubble_jump.angular.z;
+        new_step_width.x = 0.5*bubble_jump.x;
+        new_step_width.y = 0.5*bubble_jump.y;
+        new_step_width.theta = 0.5*bubble_jump.theta;
 
         // one step deeper into the recursion
         if(moveApproximateEquilibrium(bubble_num, band, curr_bubble, curr_bubble_force, new_step_width, curr_recursion_depth))
@@ -1122,103 +1594,38 @@ namespace eband_optimizer{
           new_bubble = curr_bubble;
 
 #ifdef DEBUG_EBAND_
-          geometry_msgs::Pose2D curr_bubble_pose2D;
-          PoseToPose2D(curr_bubble.center.pose, curr_bubble_pose2D);
           ROS_DEBUG("Instead - Try moving bubble %d at (%f, %f, %f) by (%f, %f, %f) to (%f, %f, %f).",
-              bubble_num, bubble_pose2D.x, bubble_pose2D.y, bubble_pose2D.theta,
-              new_step_width.linear.x, new_step_width.linear.y, new_step_width.angular.z,
-              curr_bubble_pose2D.x, curr_bubble_pose2D.y, curr_bubble_pose2D.theta);
+              bubble_num, bubble.x, bubble.y, bubble.theta,
+              new_step_width.x, new_step_width.y, new_step_width.theta,
+              curr_bubble.x, curr_bubble.y, curr_bubble.theta);
 #endif
         }
       }
     }
 
-
-    // check validity of resulting band (given the moved bubble)
-
-    // TODO use this routine not only to check whether gap can be filled but also to fill gap (if possible)
-    // get local copy of band, set new position of moved bubble and init iterators
-    std::vector<Bubble> tmp_band = band;
-    std::vector<Bubble>::iterator start_iter, end_iter;
-    tmp_band.at(bubble_num) = new_bubble;
-    start_iter = tmp_band.begin();
-
-    // check left connection (bubble and bubble-1)
-    start_iter = start_iter + bubble_num - 1;
-    end_iter = start_iter + 1;
-
-    // check Overlap - if bubbles do not overlap try to fill gap
-    if(!checkOverlap(*start_iter, *end_iter))
-    {
-      if(!fillGap(tmp_band, start_iter, end_iter))
-      {
-        ROS_DEBUG("Bubble at new position cannot be connected to neighbour. Discarding changes.");
-        // this bubble must not be changed, but band is still valid -> continue with other bubbles
-        return true;
-      }
-    }
-
-
-    // get fresh copy of band, set new position of bubble again and reinit iterators
-    tmp_band = band;
-    tmp_band.at(bubble_num) = new_bubble;
-    start_iter = tmp_band.begin();
-
-    // check right connection (bubble and bubble +1)
-    start_iter = start_iter + bubble_num;
-    end_iter = start_iter + 1;
-
-    // check Overlap - if bubbles do not overlap try to fill gap
-    if(!checkOverlap(*start_iter, *end_iter))
-    {
-      if(!fillGap(tmp_band, start_iter, end_iter))
-      {
-        ROS_DEBUG("Bubble at new position cannot be connected to neighbour. Discarding changes.");
-        // this bubble must not be changed, but band is still valid -> continue with other bubbles
-        return true;
-      }
-    }
-
-
-    // check successful - bubble and band valid apply changes
-
-#ifdef DEBUG_EBAND_
-    ROS_DEBUG("Frame %d of %d: Check successful - bubble and band valid. Applying Changes", bubble_num, ((int) band.size()) );
-#endif
-
-    band.at(bubble_num) = new_bubble;
-
     return true;
   }
 
 
-  bool EBandOptimizer::moveApproximateEquilibrium(const int& bubble_num, const std::vector<Bubble>& band, Bubble& curr_bubble,
-      const geometry_msgs::WrenchStamped& curr_bubble_force, geometry_msgs::Twist& curr_step_width, const int& curr_recursion_depth)
+  bool EBandOptimizer::moveApproximateEquilibrium(const int& bubble_num, const Band& band, BubbleState& curr_bubble,
+      const Force2D& curr_bubble_force, Twist2D& curr_step_width, const int& curr_recursion_depth)
   {
 
     double distance;
-    Bubble new_bubble = curr_bubble;
-    geometry_msgs::Pose2D new_bubble_pose2D, curr_bubble_pose2D;
-    geometry_msgs::WrenchStamped new_bubble_force = curr_bubble_force;
-
-    // move bubble
-    PoseToPose2D(curr_bubble.center.pose, curr_bubble_pose2D);
-    PoseToPose2D(new_bubble.center.pose, new_bubble_pose2D);
+    BubbleState new_bubble = curr_bubble;
+    Force2D new_bubble_force = curr_bubble_force;
 
     // apply changes to calculate tmp bubble position
-    new_bubble_pose2D.x = curr_bubble_pose2D.x + curr_step_width.linear.x;
-    new_bubble_pose2D.y = curr_bubble_pose2D.y + curr_step_width.linear.y;
-    new_bubble_pose2D.theta = curr_bubble_pose2D.theta + curr_step_width.angular.z;
-    new_bubble_pose2D.theta = angles::normalize_angle(new_bubble_pose2D.theta);
-
-    // apply changes to local copy
-    Pose2DToPose(new_bubble.center.pose, new_bubble_pose2D);
+    new_bubble.x = curr_bubble.x + curr_step_width.x;
+    new_bubble.y = curr_bubble.y + curr_step_width.y;
+    new_bubble.theta = curr_bubble.theta + curr_step_width.theta;
+    new_bubble.theta = angles::normalize_angle(new_bubble.theta);
 
 
     // check validity of moved bubble
 
     // recalc expansion of bubble -> calc Size of Bubbles by calculating Dist to nearest Obstacle [depends kinematic, environment]
-    if(!calcObstacleKinematicDistance(new_bubble.center.pose, distance))
+    if(!calcObstacleKinematicDistance(new_bubble.x, new_bubble.y, distance))
       return false;
 
     // we wont be able to calculate forces later on
@@ -1250,12 +1657,12 @@ namespace eband_optimizer{
 
     double checksum_zero, abs_new_force, abs_old_force;
     int new_recursion_depth;
-    geometry_msgs::Twist new_step_width;
+    Twist2D new_step_width;
 
     // check zero-crossing by projecting force-vectors onto each other
-    checksum_zero = (new_bubble_force.wrench.force.x * curr_bubble_force.wrench.force.x) +
-      (new_bubble_force.wrench.force.y * curr_bubble_force.wrench.force.y) +
-      (new_bubble_force.wrench.torque.z * curr_bubble_force.wrench.torque.z);
+    checksum_zero = (new_bubble_force.x * curr_bubble_force.x) +
+      (new_bubble_force.y * curr_bubble_force.y) +
+      (new_bubble_force.torque * curr_bubble_force.torque);
 
     if(checksum_zero < 0.0)
     {
@@ -1264,12 +1671,12 @@ namespace eband_optimizer{
 #endif
 
       // check the absolute values of the two vectors
-      abs_new_force = sqrt( (new_bubble_force.wrench.force.x * new_bubble_force.wrench.force.x) +
-          (new_bubble_force.wrench.force.y * new_bubble_force.wrench.force.y) +
-          (new_bubble_force.wrench.torque.z * new_bubble_force.wrench.torque.z) );
-      abs_old_force = sqrt( (curr_bubble_force.wrench.force.x * curr_bubble_force.wrench.force.x) +
-          (curr_bubble_force.wrench.force.x * curr_bubble_force.wrench.force.x) +
-          (curr_bubble_force.wrench.torque.z * curr_bubble_force.wrench.torque.z) );
+      abs_new_force = sqrt( (new_bubble_force.x * new_bubble_force.x) +
+          (new_bubble_force.y * new_bubble_force.y) +
+          (new_bubble_force.torque * new_bubble_force.torque) );
+      abs_old_force = sqrt( (curr_bubble_force.x * curr_bubble_force.x) +
+          (curr_bubble_force.y * curr_bubble_force.y) +
+          (curr_bubble_force.torque * curr_bubble_force.torque) );
 
       if( (abs_new_force > equilibrium_relative_overshoot_ * abs_old_force) && (abs_new_force > significant_force_) )
       {
@@ -1280,12 +1687,9 @@ namespace eband_optimizer{
         // o.k. now we really have to take a closer look -> start recursive approximation to equilibrium-point
         new_recursion_depth = curr_recursion_depth + 1;
         // half step size - backward direction
-        new_step_width.linear.x = -0.5*curr_step_width.linear.x;
-        new_step_width.linear.y = -0.5*curr_step_width.linear.y;
-        new_step_width.linear.z = -0.5*curr_step_width.linear.z;
-        new_step_width.angular.x = -0.5*curr_step_width.angular.x;
-        new_step_width.angular.y = -0.5*curr_step_width.angular.y;
-        new_step_width.angular.z = -0.5*curr_step_width.angular.z;
+        new_step_width.x = -0.5*curr_step_width.x;
+        new_step_width.y = -0.5*curr_step_width.y;
+        new_step_width.theta = -0.5*curr_step_width.theta;
 
         // one step deeper into the recursion
         if(moveApproximateEquilibrium(bubble_num, band, new_bubble, new_bubble_force, new_step_width, new_recursion_depth))
@@ -1306,12 +1710,9 @@ namespace eband_optimizer{
       // continue walk in same direction
       new_recursion_depth = curr_recursion_depth + 1;
       // half step size - backward direction
-      new_step_width.linear.x = 0.5*curr_step_width.linear.x;
-      new_step_width.linear.y = 0.5*curr_step_width.linear.y;
-      new_step_width.linear.z = 0.5*curr_step_width.linear.z;
-      new_step_width.angular.x = 0.5*curr_step_width.angular.x;
-      new_step_width.angular.y = 0.5*curr_step_width.angular.y;
-      new_step_width.angular.z = 0.5*curr_step_width.angular.z;
+      new_step_width.x = 0.5*curr_step_width.x;
+      new_step_width.y = 0.5*curr_step_width.y;
+      new_step_width.theta = 0.5*curr_step_width.theta;
 
       // one step deeper into the recursion
       if(moveApproximateEquilibrium(bubble_num, band, new_bubble, new_bubble_force, new_step_width, new_recursion_depth))
@@ -1326,9 +1727,9 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::getForcesAt(int bubble_num, std::vector<Bubble> band, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces)
+  bool EBandOptimizer::getForcesAt(int bubble_num, const Band& band, const BubbleState& curr_bubble, Force2D& forces)
   {
-    geometry_msgs::WrenchStamped internal_force, external_force;
+    Force2D internal_force, external_force;
 
     if(!calcInternalForces(bubble_num, band, curr_bubble, internal_force))
     {
@@ -1345,13 +1746,9 @@ namespace eband_optimizer{
     }
 
     // sum up external and internal forces over all bubbles
-    forces.wrench.force.x = internal_force.wrench.force.x + external_force.wrench.force.x;
-    forces.wrench.force.y = internal_force.wrench.force.y + external_force.wrench.force.y;
-    forces.wrench.force.z = internal_force.wrench.force.z + external_force.wrench.force.z;
-
-    forces.wrench.torque.x = internal_force.wrench.torque.x + external_force.wrench.torque.x;
-    forces.wrench.torque.y = internal_force.wrench.torque.y + external_force.wrench.torque.y;
-    forces.wrench.torque.z = internal_force.wrench.torque.z + external_force.wrench.torque.z;
+    forces.x = internal_force.x + external_force.x;
+    forces.y = internal_force.y + external_force.y;
+    forces.torque = internal_force.torque + external_force.torque;
 
     if(!suppressTangentialForces(bubble_num, band, forces))
     {
@@ -1364,7 +1761,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::calcInternalForces(int bubble_num, std::vector<Bubble> band, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces)
+  bool EBandOptimizer::calcInternalForces(int bubble_num, const Band& band, const BubbleState& curr_bubble, Force2D& forces)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1382,35 +1779,34 @@ namespace eband_optimizer{
 
     // init tmp variables
     double distance1, distance2;
-    geometry_msgs::Twist difference1, difference2;
-    geometry_msgs::Wrench wrench;
+    Twist2D difference1, difference2;
 
     // make sure this method was called for a valid element in the forces or bubbles vector
     ROS_ASSERT( bubble_num > 0 );
-    ROS_ASSERT( bubble_num < ((int) band.size() - 1) );
+    ROS_ASSERT( bubble_num < (band.size() - 1) );
 
 
     // get distance between bubbles
-    if(!calcBubbleDistance(curr_bubble.center.pose, band[bubble_num-1].center.pose, distance1))
+    if(!calcBubbleDistance(curr_bubble, band.get(bubble_num-1), distance1))
     {
       ROS_ERROR("Failed to calculate Distance between two bubbles. Aborting calculation of internal forces!");
       return false;
     }
 
-    if(!calcBubbleDistance(curr_bubble.center.pose, band[bubble_num+1].center.pose, distance2))
+    if(!calcBubbleDistance(curr_bubble, band.get(bubble_num+1), distance2))
     {
       ROS_ERROR("Failed to calculate Distance between two bubbles. Aborting calculation of internal forces!");
       return false;
     }
 
     // get (elementwise) difference bewtween bubbles
-    if(!calcBubbleDifference(curr_bubble.center.pose, band[bubble_num-1].center.pose, difference1))
+    if(!calcBubbleDifference(curr_bubble, band.get(bubble_num-1), difference1))
     {
       ROS_ERROR("Failed to calculate Difference between two bubbles. Aborting calculation of internal forces!");
       return false;
     }
 
-    if(!calcBubbleDifference(curr_bubble.center.pose, band[bubble_num+1].center.pose, difference2))
+    if(!calcBubbleDifference(curr_bubble, band.get(bubble_num+1), difference2))
     {
       ROS_ERROR("Failed to calculate Difference between two bubbles. Aborting calculation of internal forces!");
       return false;
@@ -1423,26 +1819,20 @@ namespace eband_optimizer{
     if(distance2 <= tiny_bubble_distance_)
       distance2 = 1000000.0;
 
-    // now calculate wrench - forces model an elastic band and are normed (distance) to render forces for small and large bubbles the same
-    wrench.force.x = internal_force_gain_*(difference1.linear.x/distance1 + difference2.linear.x/distance2);
-    wrench.force.y = internal_force_gain_*(difference1.linear.y/distance1 + difference2.linear.y/distance2);
-    wrench.force.z = internal_force_gain_*(difference1.linear.z/distance1 + difference2.linear.z/distance2);
-    wrench.torque.x = internal_force_gain_*(difference1.angular.x/distance1 + difference2.angular.x/distance2);
-    wrench.torque.y = internal_force_gain_*(difference1.angular.y/distance1 + difference2.angular.y/distance2);
-    wrench.torque.z = internal_force_gain_*(difference1.angular.z/distance1 + difference2.angular.z/distance2);
+    // now calculate forces - forces model an elastic band and are normed (distance) to render forces for small and large bubbles the same
+    forces.x = internal_force_gain_*(difference1.x/distance1 + difference2.x/distance2);
+    forces.y = internal_force_gain_*(difference1.y/distance1 + difference2.y/distance2);
+    forces.torque = internal_force_gain_*(difference1.theta/distance1 + difference2.theta/distance2);
 
 #ifdef DEBUG_EBAND_
-    ROS_DEBUG("Calculating internal forces: (x, y, theta) = (%f, %f, %f)", wrench.force.x, wrench.force.y, wrench.torque.z);
+    ROS_DEBUG("Calculating internal forces: (x, y, theta) = (%f, %f, %f)", forces.x, forces.y, forces.torque);
 #endif
 
-    // store wrench in vector
-    forces.wrench = wrench;
-
     return true;
   }
 
 
-  bool EBandOptimizer::calcExternalForces(int bubble_num, Bubble curr_bubble, geometry_msgs::WrenchStamped& forces)
+  bool EBandOptimizer::calcExternalForces(int bubble_num, const BubbleState& curr_bubble, Force2D& forces)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1453,58 +1843,29 @@ namespace eband_optimizer{
 
     // init tmp variables
     double distance1, distance2;
-    geometry_msgs::Pose edge;
-    geometry_msgs::Pose2D edge_pose2D;
-    geometry_msgs::Wrench wrench;
+    Force2D force;
 
-
-    // calculate delta-poses (on upper edge of bubble) for x-direction
-    edge = curr_bubble.center.pose;
-    edge.position.x = edge.position.x + curr_bubble.expansion;
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance1))
-    {
-      ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
-      // we cannot calculate external forces for this bubble - but still continue for the other bubbles
-      return true;
-    }
-    // calculate delta-poses (on lower edge of bubble) for x-direction
-    edge.position.x = edge.position.x - 2.0*curr_bubble.expansion;
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance2))
+    // with a distance field the force follows the interpolated gradient of the distance directly
+    double distance, gradient_x, gradient_y;
+    if(calcObstacleFieldDistance(curr_bubble.x, curr_bubble.y, distance, gradient_x, gradient_y))
     {
-      ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
-      // we cannot calculate external forces for this bubble - but still continue for the other bubbles
+      forces.x = external_force_gain_*gradient_x;
+      forces.y = external_force_gain_*gradient_y;
+      forces.torque = 0.0;
       return true;
     }
 
-    // calculate difference-quotient (approx. of derivative) in x-direction
-    if(curr_bubble.expansion <= tiny_bubble_expansion_)
-    {
-      // avoid division by (almost) zero to avoid numerical problems
-      wrench.force.x = -external_force_gain_*(distance2 - distance1)/(2.0*tiny_bubble_expansion_);
-      // actually we should never end up here - band should have been considered as broken
-      ROS_DEBUG("Calculating external forces on broken band. Bubble should have been removed. Local Planner probably ill configured");
-    }
-    else
-      wrench.force.x = -external_force_gain_*(distance2 - distance1)/(2.0*curr_bubble.expansion);
-    // TODO above equations skip term to make forces continuous at end of influence region - test to add corresponding term
+    // otherwise approximate the gradient by difference-quotients over the bubble
 
-
-    // calculate delta-poses (on upper edge of bubble) for y-direction
-    edge = curr_bubble.center.pose;
-    edge.position.y = edge.position.y + curr_bubble.expansion;
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance1))
+    // get expansion on bubble at upper edge of bubble for x-direction
+    if(!calcObstacleKinematicDistance(curr_bubble.x + curr_bubble.expansion, curr_bubble.y, distance1))
     {
       ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
       // we cannot calculate external forces for this bubble - but still continue for the other bubbles
       return true;
     }
-    // calculate delta-poses (on lower edge of bubble) for x-direction
-    edge.position.y = edge.position.y - 2.0*curr_bubble.expansion;
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance2))
+    // get expansion on bubble at lower edge of bubble for x-direction
+    if(!calcObstacleKinematicDistance(curr_bubble.x - curr_bubble.expansion, curr_bubble.y, distance2))
     {
       ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
       // we cannot calculate external forces for this bubble - but still continue for the other bubbles
@@ -1515,73 +1876,60 @@ namespace eband_optimizer{
     if(curr_bubble.expansion <= tiny_bubble_expansion_)
     {
       // avoid division by (almost) zero to avoid numerical problems
-      wrench.force.y = -external_force_gain_*(distance2 - distance1)/(2.0*tiny_bubble_expansion_);
+      force.x = -external_force_gain_*(distance2 - distance1)/(2.0*tiny_bubble_expansion_);
       // actually we should never end up here - band should have been considered as broken
       ROS_DEBUG("Calculating external forces on broken band. Bubble should have been removed. Local Planner probably ill configured");
     }
     else
-      wrench.force.y = -external_force_gain_*(distance2 - distance1)/(2.0*curr_bubble.expansion);
-    // TODO above equations skip term to make forces continuous at end of influence region - test to add corresponsing term
-
-
-    // no force in z-direction
-    wrench.force.z = 0.0;
-
-
-    // no torque around x and y axis
-    wrench.torque.x = 0.0;
-    wrench.torque.y = 0.0;
+      force.x = -external_force_gain_*(distance2 - distance1)/(2.0*curr_bubble.expansion);
+    // TODO above equations skip term to make forces continuous at end of influence region - test to add corresponding term
 
 
-    // calculate delta-poses (on upper edge of bubble) for x-direction
-    PoseToPose2D(curr_bubble.center.pose, edge_pose2D);
-    edge_pose2D.theta = edge_pose2D.theta + (curr_bubble.expansion/map_->robot_radius);
-    edge_pose2D.theta = angles::normalize_angle(edge_pose2D.theta);
-    PoseToPose2D(edge, edge_pose2D);
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance1))
+    // get expansion on bubble at upper edge of bubble for y-direction
+    if(!calcObstacleKinematicDistance(curr_bubble.x, curr_bubble.y + curr_bubble.expansion, distance1))
     {
       ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
       // we cannot calculate external forces for this bubble - but still continue for the other bubbles
       return true;
     }
-    // calculate delta-poses (on lower edge of bubble) for x-direction
-    edge_pose2D.theta = edge_pose2D.theta - 2.0*(curr_bubble.expansion/map_->robot_radius);
-    edge_pose2D.theta = angles::normalize_angle(edge_pose2D.theta);
-    PoseToPose2D(edge, edge_pose2D);
-    // get expansion on bubble at this point
-    if(!calcObstacleKinematicDistance(edge, distance2))
+    // get expansion on bubble at lower edge of bubble for y-direction
+    if(!calcObstacleKinematicDistance(curr_bubble.x, curr_bubble.y - curr_bubble.expansion, distance2))
     {
       ROS_DEBUG("Bubble %d probably at edge of map - cannot retrieve distance information to calculate external forces", bubble_num);
       // we cannot calculate external forces for this bubble - but still continue for the other bubbles
       return true;
     }
 
-    // calculate difference-quotient (approx. of derivative) in x-direction
+    // calculate difference-quotient (approx. of derivative) in y-direction
     if(curr_bubble.expansion <= tiny_bubble_expansion_)
     {
       // avoid division by (almost) zero to avoid numerical problems
-      wrench.torque.z = -external_force_gain_*(distance2 - distance1)/(2.0*tiny_bubble_expansion_);
+      force.y = -external_force_gain_*(distance2 - distance1)/(2.0*tiny_bubble_expansion_);
       // actually we should never end up here - band should have been considered as broken
       ROS_DEBUG("Calculating external forces on broken band. Bubble should have been removed. Local Planner probably ill configured");
     }
     else
-      wrench.torque.z = -external_force_gain_*(distance2 - distance1)/(2.0*curr_bubble.expansion);
+      force.y = -external_force_gain_*(distance2 - distance1)/(2.0*curr_bubble.expansion);
     // TODO above equations skip term to make forces continuous at end of influence region - test to add corresponsing term
 
 
+    // distance to obstacles is read from the map at the center of the bubble and does not depend on the orientation
+    // of the robot -> difference-quotient in theta-direction and with it the torque is zero
+    force.torque = 0.0;
+
+
 #ifdef DEBUG_EBAND_
-    ROS_DEBUG("Calculating external forces: (x, y, theta) = (%f, %f, %f)", wrench.force.x, wrench.force.y, wrench.torque.z);
+    ROS_DEBUG("Calculating external forces: (x, y, theta) = (%f, %f, %f)", force.x, force.y, force.torque);
 #endif
 
-    // assign wrench to forces vector
-    forces.wrench = wrench;
+    // assign force to forces vector
+    forces = force;
 
     return true;
   }
 
 
-  bool EBandOptimizer::suppressTangentialForces(int bubble_num, std::vector<Bubble> band, geometry_msgs::WrenchStamped& forces)
+  bool EBandOptimizer::suppressTangentialForces(int bubble_num, const Band& band, Force2D& forces)
   {
     //cycle over all bubbles except first and last (these are fixed)
     if(band.size() <= 2)
@@ -1591,26 +1939,23 @@ namespace eband_optimizer{
     }
 
     double scalar_fd, scalar_dd;
-    geometry_msgs::Twist difference;
+    Twist2D difference;
 
     // make sure this method was called for a valid element in the forces or bubbles vector
     ROS_ASSERT( bubble_num > 0 );
-    ROS_ASSERT( bubble_num < ((int) band.size() - 1) );
+    ROS_ASSERT( bubble_num < (band.size() - 1) );
 
 
     // get pose-difference from following to preceding bubble -> "direction of the band in this bubble"
-    if(!calcBubbleDifference(band[bubble_num+1].center.pose, band[bubble_num-1].center.pose, difference))
+    if(!calcBubbleDifference(band.get(bubble_num+1), band.get(bubble_num-1), difference))
       return false;
 
     // "project wrench" in middle bubble onto connecting vector
     // scalar wrench*difference
-    scalar_fd = forces.wrench.force.x*difference.linear.x + forces.wrench.force.y*difference.linear.y +
-      forces.wrench.force.z*difference.linear.z + forces.wrench.torque.x*difference.angular.x +
-      forces.wrench.torque.y*difference.angular.y + forces.wrench.torque.z*difference.angular.z;
+    scalar_fd = forces.x*difference.x + forces.y*difference.y + forces.torque*difference.theta;
 
     // abs of difference-vector: scalar difference*difference
-    scalar_dd = difference.linear.x*difference.linear.x + difference.linear.y*difference.linear.y + difference.linear.z*difference.linear.z +
-      difference.angular.x*difference.angular.x + difference.angular.y*difference.angular.y + difference.angular.z*difference.angular.z;
+    scalar_dd = difference.x*difference.x + difference.y*difference.y + difference.theta*difference.theta;
 
     // avoid division by (almost) zero -> check if bubbles have (almost) same center-pose
     if(scalar_dd <= tiny_bubble_distance_)
@@ -1620,16 +1965,13 @@ namespace eband_optimizer{
     }
 
     // calculate orthogonal components
-    forces.wrench.force.x = forces.wrench.force.x - scalar_fd/scalar_dd * difference.linear.x;
-    forces.wrench.force.y = forces.wrench.force.y - scalar_fd/scalar_dd * difference.linear.y;
-    forces.wrench.force.z = forces.wrench.force.z - scalar_fd/scalar_dd * difference.linear.z;
-    forces.wrench.torque.x = forces.wrench.torque.x - scalar_fd/scalar_dd * difference.angular.x;
-    forces.wrench.torque.y = forces.wrench.torque.y - scalar_fd/scalar_dd * difference.angular.y;
-    forces.wrench.torque.z = forces.wrench.torque.z - scalar_fd/scalar_dd * difference.angular.z;
+    forces.x = forces.x - scalar_fd/scalar_dd * difference.x;
+    forces.y = forces.y - scalar_fd/scalar_dd * difference.y;
+    forces.torque = forces.torque - scalar_fd/scalar_dd * difference.theta;
 
 #ifdef DEBUG_EBAND_
     ROS_DEBUG("Supressing tangential forces: (x, y, theta) = (%f, %f, %f)",
-        forces.wrench.force.x, forces.wrench.force.y, forces.wrench.torque.z);
+        forces.x, forces.y, forces.torque);
 #endif
 
     return true;
@@ -1638,7 +1980,7 @@ namespace eband_optimizer{
 
   // problem (geometry) dependant functions
 
-  bool EBandOptimizer::interpolateBubbles(geometry_msgs::PoseStamped start_center, geometry_msgs::PoseStamped end_center, geometry_msgs::PoseStamped& interpolated_center)
+  bool EBandOptimizer::interpolateBubbles(const BubbleState& start_bubble, const BubbleState& end_bubble, BubbleState& interpolated_bubble)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1648,33 +1990,18 @@ namespace eband_optimizer{
     }
 
     // instantiate local variables
-    geometry_msgs::Pose2D start_pose2D, end_pose2D, interpolated_pose2D;
     double delta_theta;
 
-    // copy header
-    interpolated_center.header = start_center.header;
-
     // interpolate angles
-    // TODO make this in a better way
-    // - for instance use "slerp" to interpolate directly between quaternions
-    // - or work with pose2D right from the beginnning
-    // convert quaternions to euler angles - at this point this no longer works in 3D !!
-    PoseToPose2D(start_center.pose, start_pose2D);
-    PoseToPose2D(end_center.pose, end_pose2D);
     // calc mean of theta angle
-    delta_theta = end_pose2D.theta - start_pose2D.theta;
+    delta_theta = end_bubble.theta - start_bubble.theta;
     delta_theta = angles::normalize_angle(delta_theta) / 2.0;
-    interpolated_pose2D.theta = start_pose2D.theta + delta_theta;
-    interpolated_pose2D.theta = angles::normalize_angle(interpolated_pose2D.theta);
-    // convert back to quaternion
-    interpolated_pose2D.x = 0.0;
-    interpolated_pose2D.y = 0.0;
-    Pose2DToPose(interpolated_center.pose, interpolated_pose2D);
+    interpolated_bubble.theta = start_bubble.theta + delta_theta;
+    interpolated_bubble.theta = angles::normalize_angle(interpolated_bubble.theta);
 
     // interpolate positions
-    interpolated_center.pose.position.x = (end_center.pose.position.x + start_center.pose.position.x)/2.0;
-    interpolated_center.pose.position.y = (end_center.pose.position.y + start_center.pose.position.y)/2.0;
-    interpolated_center.pose.position.z = (end_center.pose.position.z + start_center.pose.position.z)/2.0;
+    interpolated_bubble.x = (end_bubble.x + start_bubble.x)/2.0;
+    interpolated_bubble.y = (end_bubble.y + start_bubble.y)/2.0;
 
     // TODO ideally this would take into account kinematics of the robot and for instance use splines
 
@@ -1682,7 +2009,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::checkOverlap(Bubble bubble1, Bubble bubble2)
+  bool EBandOptimizer::checkOverlap(const BubbleState& bubble1, const BubbleState& bubble2)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1693,7 +2020,7 @@ namespace eband_optimizer{
 
     // calc (kinematic) Distance between bubbles
     double distance = 0.0;
-    if(!calcBubbleDistance(bubble1.center.pose, bubble2.center.pose, distance))
+    if(!calcBubbleDistance(bubble1, bubble2, distance))
     {
       ROS_ERROR("failed to calculate Distance between two bubbles. Aborting check for overlap!");
       return false;
@@ -1710,7 +2037,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::calcBubbleDistance(geometry_msgs::Pose start_center_pose, geometry_msgs::Pose end_center_pose, double& distance)
+  bool EBandOptimizer::calcBubbleDistance(const BubbleState& start_bubble, const BubbleState& end_bubble, double& distance)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1719,25 +2046,12 @@ namespace eband_optimizer{
       return false;
     }
 
-    geometry_msgs::Pose2D start_pose2D, end_pose2D, diff_pose2D;
-
-    // TODO make this in a better way
-    // - or work with pose2D right from the beginnning
-    // convert quaternions to euler angles - at this point this no longer works in 3D !!
-    PoseToPose2D(start_center_pose, start_pose2D);
-    PoseToPose2D(end_center_pose, end_pose2D);
-
-    // get rotational difference
-    diff_pose2D.theta = end_pose2D.theta - start_pose2D.theta;
-    diff_pose2D.theta = angles::normalize_angle(diff_pose2D.theta);
     // get translational difference
-    diff_pose2D.x = end_pose2D.x - start_pose2D.x;
-    diff_pose2D.y = end_pose2D.y - start_pose2D.y;
+    double diff_x = end_bubble.x - start_bubble.x;
+    double diff_y = end_bubble.y - start_bubble.y;
 
-    // calc distance
-    double angle_to_pseudo_vel = diff_pose2D.theta * map_->robot_radius;
-    //distance = sqrt( (diff_pose2D.x * diff_pose2D.x) + (diff_pose2D.y * diff_pose2D.y) + (angle_to_pseudo_vel * angle_to_pseudo_vel) );
-    distance = sqrt( (diff_pose2D.x * diff_pose2D.x) + (diff_pose2D.y * diff_pose2D.y));
+    // calc distance, rotational difference is not taken into account
+    distance = sqrt( (diff_x * diff_x) + (diff_y * diff_y));
 
     // TODO take into account kinematic properties of body
 
@@ -1745,7 +2059,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::calcBubbleDifference(geometry_msgs::Pose start_center_pose, geometry_msgs::Pose end_center_pose, geometry_msgs::Twist& difference)
+  bool EBandOptimizer::calcBubbleDifference(const BubbleState& start_bubble, const BubbleState& end_bubble, Twist2D& difference)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1754,28 +2068,12 @@ namespace eband_optimizer{
       return false;
     }
 
-    geometry_msgs::Pose2D start_pose2D, end_pose2D, diff_pose2D;
-
-    // TODO make this in a better way
-    // - or work with pose2D right from the beginnning
-    // convert quaternions to euler angles - at this point this no longer works in 3D !!
-    PoseToPose2D(start_center_pose, start_pose2D);
-    PoseToPose2D(end_center_pose, end_pose2D);
-
-    // get rotational difference
-    diff_pose2D.theta = end_pose2D.theta - start_pose2D.theta;
-    diff_pose2D.theta = angles::normalize_angle(diff_pose2D.theta);
     // get translational difference
-    diff_pose2D.x = end_pose2D.x - start_pose2D.x;
-    diff_pose2D.y = end_pose2D.y - start_pose2D.y;
+    difference.x = end_bubble.x - start_bubble.x;
+    difference.y = end_bubble.y - start_bubble.y;
 
-    difference.linear.x = diff_pose2D.x;
-    difference.linear.y = diff_pose2D.y;
-    difference.linear.z = 0.0;
-    // multiply by inscribed radius to math calculation of distance
-    difference.angular.x = 0.0;
-    difference.angular.y = 0.0;
-    difference.angular.z = diff_pose2D.theta*map_->robot_radius;
+    // get rotational difference and multiply by inscribed radius to math calculation of distance
+    difference.theta = angles::normalize_angle(end_bubble.theta - start_bubble.theta) * map_->robot_radius;
 
     // TODO take into account kinematic properties of body
 
@@ -1783,7 +2081,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::calcObstacleKinematicDistance(geometry_msgs::Pose center_pose, double& distance)
+  bool EBandOptimizer::calcObstacleKinematicDistance(double x, double y, double& distance)
   {
     // calculate distance to nearest obstacle [depends kinematic, shape, environment]
 
@@ -1794,6 +2092,10 @@ namespace eband_optimizer{
       return false;
     }
 
+    double gradient_x, gradient_y;
+    if(calcObstacleFieldDistance(x, y, distance, gradient_x, gradient_y))
+      return true;
+
     unsigned int cell_x, cell_y;
     signed char disc_cost;
     signed char collision_cost = 99;
@@ -1803,7 +2105,7 @@ namespace eband_optimizer{
     // read distance to nearest obstacle directly from costmap
     // (does not take into account shape and kinematic properties)
     // get cell for coordinates of bubble center
-    if(!map_->worldToMap(center_pose.position.x, center_pose.position.y, cell_x, cell_y)) {
+    if(!map_->worldToMap(x, y, cell_x, cell_y)) {
       // probably at the edge of the costmap - this value should be recovered soon
       disc_cost = 1;
     } else {
@@ -1845,9 +2147,36 @@ namespace eband_optimizer{
   }
 
 
+  bool EBandOptimizer::calcObstacleFieldDistance(double x, double y, double& distance, double& gradient_x, double& gradient_y)
+  {
+    if(distance_field_ == nullptr || !distance_field_->matches(map_->width, map_->height))
+      return false;
+
+    // the field is in cells of the map
+    double cell_x = (x - map_->origin.position.x) / map_->resolution;
+    double cell_y = (y - map_->origin.position.y) / map_->resolution;
+    if(!distance_field_->getInterpolated(cell_x, cell_y, distance, gradient_x, gradient_y))
+      return false;
+
+    distance = distance * map_->resolution;
+
+    // limit to the distance of the lowest non freespace cost in calcObstacleKinematicDistance, so that bubbles in
+    // freespace keep the same size -> beyond it obstacles do not push the band
+    double max_distance = log(79.0) / costmap_weight_;
+    if(distance >= max_distance)
+    {
+      distance = max_distance;
+      gradient_x = 0.0;
+      gradient_y = 0.0;
+    }
+
+    return true;
+  }
+
+
   // type conversions
 
-  bool EBandOptimizer::convertPlanToBand(std::vector<geometry_msgs::PoseStamped> plan, std::vector<Bubble>& band)
+  bool EBandOptimizer::convertPlanToBand(const std::vector<geometry_msgs::PoseStamped>& plan, Band& band)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1858,15 +2187,13 @@ namespace eband_optimizer{
 
     // create local variables
     double distance = 0.0;
-    std::vector<Bubble> tmp_band;
+    geometry_msgs::Pose2D center_pose2D;
+    Band tmp_band;
 
     ROS_DEBUG("Copying plan to band - Conversion started: %d frames to convert.", ((int) plan.size()) );
 
-    // get local copy of referenced variable
-    tmp_band = band;
-
     // adapt band to plan
-    tmp_band.resize(plan.size());
+    tmp_band.reserve(plan.size());
     for(int i = 0; i < ((int) plan.size()); i++)
     {
 #ifdef DEBUG_EBAND_
@@ -1874,10 +2201,10 @@ namespace eband_optimizer{
 #endif
 
       // set poses in plan as centers of bubbles
-      tmp_band[i].center = plan[i];
+      PoseToPose2D(plan[i].pose, center_pose2D);
 
       // calc Size of Bubbles by calculating Dist to nearest Obstacle [depends kinematic, environment]
-      if(!calcObstacleKinematicDistance(tmp_band[i].center.pose, distance))
+      if(!calcObstacleKinematicDistance(center_pose2D.x, center_pose2D.y, distance))
       {
         // frame must not be immediately in collision -> otherwise calculation of gradient will later be invalid
         ROS_WARN("Calculation of Distance between bubble and nearest obstacle failed. Frame %d of %d outside map", i, ((int) plan.size()) );
@@ -1894,7 +2221,7 @@ namespace eband_optimizer{
 
 
       // assign to expansion of bubble
-      tmp_band[i].expansion = distance;
+      tmp_band.push_back(BubbleState{center_pose2D.x, center_pose2D.y, center_pose2D.theta, distance});
     }
 
     // write to referenced variable
@@ -1905,7 +2232,7 @@ namespace eband_optimizer{
   }
 
 
-  bool EBandOptimizer::convertBandToPlan(std::vector<geometry_msgs::PoseStamped>& plan, std::vector<Bubble> band)
+  bool EBandOptimizer::convertBandToPlan(std::vector<geometry_msgs::PoseStamped>& plan, const Band& band, const std_msgs::Header& header)
   {
     // check if plugin initialized
     if(!initialized_)
@@ -1916,13 +2243,18 @@ namespace eband_optimizer{
 
     // create local variables
     std::vector<geometry_msgs::PoseStamped> tmp_plan;
+    geometry_msgs::Pose2D center_pose2D;
 
     // adapt plan to band
     tmp_plan.resize(band.size());
-    for(int i = 0; i < ((int) band.size()); i++)
+    for(int i = 0; i < band.size(); i++)
     {
       // set centers of bubbles to StampedPose in plan
-      tmp_plan[i] = band[i].center;
+      center_pose2D.x = band.x[i];
+      center_pose2D.y = band.y[i];
+      center_pose2D.theta = band.theta[i];
+      tmp_plan[i].header = header;
+      Pose2DToPose(tmp_plan[i].pose, center_pose2D);
     }
 
     //write to referenced variable and done
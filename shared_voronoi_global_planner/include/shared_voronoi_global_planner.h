@@ -112,10 +112,29 @@ namespace shared_voronoi_global_planner
         int pixels_to_skip = 0;
 
         /**
-         * Downscale factor used for scaling map before finding contours. Smaller values increase speed (possibly marginal)
-         * but may decrease the accuracy of the centroids found
+         * Only relabel obstacles near cells that changed since the previous map when finding obstacle points
          **/
-        double open_cv_scale = 0.25;
+        bool incremental_obstacle_labeling = false;
+
+        /**
+         * Obstacles separated by at most this many free pixels are merged for homotopy classes
+         **/
+        int obstacle_merge_gap = 0;
+
+        /**
+         * Obstacles with fewer occupied pixels than this are merged into the nearest larger obstacle
+         **/
+        int obstacle_merge_area = 0;
+
+        /**
+         * Maximum number of obstacles used for homotopy classes, 0 for no limit
+         **/
+        int max_homotopy_obstacles = 0;
+
+        /**
+         * Keep obstacles closest to the robot instead of the largest obstacles when limiting the number of obstacles
+         **/
+        bool obstacle_rank_by_robot_distance = false;
 
         /**
          * Threshold to classify a homotopy class as same or different. Ideally, same homotopy classes should have identical 
@@ -230,7 +249,53 @@ namespace shared_voronoi_global_planner
          **/
         double joy_input_thresh = 0.8;
 
+        /**
+         * Method used to find alternative paths, "yen" for Yen's kth shortest paths or "penalty" for the iterative penalty method
+         **/
+        std::string alternative_path_method = "yen";
+
+        /**
+         * Invariant used to compare homotopy classes, "h_signature" or "crossing_word"
+         **/
+        std::string homotopy_invariant = "h_signature";
+
+        /**
+         * Multiplier applied to the weight of an edge each time it is used by a path found by the penalty method
+         **/
+        double penalty_factor = 1.5;
+
+        /**
+         * Maximum number of searches done by the penalty method before it stops looking for more paths
+         **/
+        int penalty_max_iterations = 20;
+
+        /**
+         * Number of landmarks used for the ALT heuristic during graph search, 0 to disable
+         **/
+        int num_landmarks = 0;
+
+        /**
+         * Whether to preprocess the voronoi graph into a contraction hierarchy, only used when static_global_map is true
+         **/
+        bool use_contraction_hierarchy = false;
+
+        /**
+         * Whether to keep and repair the search tree of the current goal between plans using D* Lite
+         **/
+        bool use_incremental_search = false;
+
+        /**
+         * Time budget (s) for finding alternative paths in each plan, 0 for no limit
+         **/
+        double planning_time_budget = 0;
+
+        /**
+         * Distance (m) between start and goal above which graph searches are bidirectional, 0 to disable
+         **/
+        double bidirectional_search_threshold = 0;
+
         bool use_elastic_band = false;
+        bool warm_start_elastic_band = false;
 
         /**
          * Distance in meters before exhaustive path exploration terminates
@@ -248,6 +313,8 @@ namespace shared_voronoi_global_planner
         double equilibrium_relative_overshoot_ = 0.75; ///@brief percentage of old force for which a new force is considered significant when higher as this value
         double significant_force_ = 0.15; ///@brief lower bound for absolute value of force below which it is treated as insignificant (no recursive approximation)
         double costmap_weight_ = 10.0; // the costmap weight or scaling factor
+        bool jacobi_update_ = false;
+        bool converge_on_residual_ = false;
 
         /**
          * Interval variable to store the preffered path from previous time step. Defaults to 0 which is the shortest path
@@ -181,12 +181,16 @@ namespace shared_voronoi_global_planner
             //Clear all previous paths and preferences before getting new path
             v_path.clearPreviousPaths();
             preferred_path = 0;
-            all_paths = v_path.getPath(start_point, end_point, num_paths);
+            bool partial;
+            all_paths = v_path.getPath(start_point, end_point, num_paths, planning_time_budget, partial);
             prev_goal = end_point;
+
+            if (partial)
+                ROS_DEBUG("Planning time budget of %.3fs exceeded, %zu paths found so far", planning_time_budget, all_paths.size());
         }
 
         if (all_paths.size() < num_paths)
-            ROS_WARN("Could not find all requested paths. Requested: %d, found: %ld", num_paths, all_paths.size());
+            ROS_WARN("Could not find all requested paths. Requested: %d, found: %zu", num_paths, all_paths.size());
 
         //If paths are found and plan is not filled yet
         if (!all_paths.empty() && plan.empty())
@@ -541,6 +545,10 @@ namespace shared_voronoi_global_planner
 
         tf2::doTransform<geometry_msgs::Pose>(msg_.pose.pose, msg_.pose.pose, odom2maptf);
 
+        //Robot position in pixels, used to rank obstacles for homotopy classes
+        v_path.setRobotPosition(GraphNode((msg_.pose.pose.position.x - map.origin.position.x) / map.resolution,
+                                          (msg_.pose.pose.position.y - map.origin.position.y) / map.resolution));
+
         //last_sorted_position pose will be 0 if it was not initialized before
         double dist = pow(msg_.pose.pose.position.x - last_sorted_position.pose.pose.position.x, 2) +
                       pow(msg_.pose.pose.position.y - last_sorted_position.pose.pose.position.y, 2);
@@ -571,7 +579,9 @@ namespace shared_voronoi_global_planner
         std::vector<GraphNode> nodes;
         std::vector<GraphNode> lonely_nodes;
         std::vector<GraphNode> centers;
+        std::vector<voronoi_path::ObstacleCluster> clusters;
         v_path.getObstacleCentroids(centers);
+        v_path.getObstacleClusters(clusters);
         v_path.getEdges(nodes);
         v_path.getDisconnectedNodes(lonely_nodes);
 
@@ -650,7 +660,39 @@ namespace shared_voronoi_global_planner
             marker_obstacles.points.push_back(std::move(temp_point));
         }
 
+        //Markers joining every obstacle to the representative of the cluster it was merged into
+        visualization_msgs::Marker marker_clusters;
+        marker_clusters.header.stamp = ros::Time::now();
+        marker_clusters.header.frame_id = map.frame_id;
+        marker_clusters.id = 3;
+        marker_clusters.ns = "Obstacle Clusters";
+        marker_clusters.type = 5;
+        marker_clusters.action = 0;
+        marker_clusters.scale.x = 0.02;
+        marker_clusters.color.a = 1.0;
+        marker_clusters.color.g = 1.0;
+        marker_clusters.color.b = 1.0;
+        marker_clusters.pose.orientation.w = 1.0;
+
+        for (const auto &cluster : clusters)
+        {
+            geometry_msgs::Point representative;
+            representative.x = cluster.representative.x * static_cast<double>(map.resolution) + map.origin.position.x;
+            representative.y = cluster.representative.y * static_cast<double>(map.resolution) + map.origin.position.y;
+
+            for (const auto &member : cluster.members)
+            {
+                geometry_msgs::Point temp_point;
+                temp_point.x = member.x * static_cast<double>(map.resolution) + map.origin.position.x;
+                temp_point.y = member.y * static_cast<double>(map.resolution) + map.origin.position.y;
+
+                marker_clusters.points.push_back(representative);
+                marker_clusters.points.push_back(std::move(temp_point));
+            }
+        }
+
         marker_array.markers.push_back(std::move(marker_obstacles));
+        marker_array.markers.push_back(std::move(marker_clusters));
         marker_array.markers.push_back(std::move(marker));
         marker_array.markers.push_back(std::move(marker_lonely));
         edges_viz_pub.publish(marker_array);
@@ -664,7 +706,6 @@ namespace shared_voronoi_global_planner
         nh.getParam("print_timings", print_timings);
         nh.getParam("line_check_resolution", line_check_resolution);
         nh.getParam("pixels_to_skip", pixels_to_skip);
-        nh.getParam("open_cv_scale", open_cv_scale);
         nh.getParam("h_class_threshold", h_class_threshold);
         nh.getParam("min_node_sep_sq", min_node_sep_sq);
         nh.getParam("extra_point_distance", extra_point_distance);
@@ -691,6 +732,20 @@ namespace shared_voronoi_global_planner
         nh.getParam("joy_input_thresh", joy_input_thresh);
         nh.getParam("publish_path_point_markers", publish_path_point_markers);
         nh.getParam("path_vertex_angle_threshold", path_vertex_angle_threshold);
+        nh.getParam("alternative_path_method", alternative_path_method);
+        nh.getParam("homotopy_invariant", homotopy_invariant);
+        nh.getParam("incremental_obstacle_labeling", incremental_obstacle_labeling);
+        nh.getParam("obstacle_merge_gap", obstacle_merge_gap);
+        nh.getParam("obstacle_merge_area", obstacle_merge_area);
+        nh.getParam("max_homotopy_obstacles", max_homotopy_obstacles);
+        nh.getParam("obstacle_rank_by_robot_distance", obstacle_rank_by_robot_distance);
+        nh.getParam("penalty_factor", penalty_factor);
+        nh.getParam("penalty_max_iterations", penalty_max_iterations);
+        nh.getParam("num_landmarks", num_landmarks);
+        nh.getParam("use_contraction_hierarchy", use_contraction_hierarchy);
+        nh.getParam("use_incremental_search", use_incremental_search);
+        nh.getParam("planning_time_budget", planning_time_budget);
+        nh.getParam("bidirectional_search_threshold", bidirectional_search_threshold);
 
         //Set parameters for voronoi path object
         v_path.h_class_threshold = h_class_threshold;
@@ -700,14 +755,48 @@ namespace shared_voronoi_global_planner
         v_path.min_node_sep_sq = min_node_sep_sq;
         v_path.trimming_collision_threshold = trimming_collision_threshold;
         v_path.search_radius = search_radius;
-        v_path.open_cv_scale = open_cv_scale;
+        v_path.incremental_obstacle_labeling = incremental_obstacle_labeling;
+        v_path.obstacle_merge_gap = obstacle_merge_gap;
+        v_path.obstacle_merge_area = obstacle_merge_area;
+        v_path.max_homotopy_obstacles = max_homotopy_obstacles;
+        v_path.obstacle_rank_by_robot_distance = obstacle_rank_by_robot_distance;
         v_path.pixels_to_skip = pixels_to_skip;
         v_path.lonely_branch_dist_threshold = lonely_branch_dist_threshold;
         v_path.path_waypoint_sep = path_waypoint_sep;
         v_path.path_vertex_angle_threshold = path_vertex_angle_threshold;
+        v_path.penalty_factor = penalty_factor;
+        v_path.penalty_max_iterations = penalty_max_iterations;
+        v_path.num_landmarks = num_landmarks;
+        v_path.use_contraction_hierarchy = static_global_map && use_contraction_hierarchy;
+        v_path.use_incremental_search = use_incremental_search;
+        v_path.planning_time_budget = planning_time_budget;
+        v_path.bidirectional_search_threshold = bidirectional_search_threshold;
+
+        if (alternative_path_method == "penalty")
+            v_path.alternative_path_method = voronoi_path::AlternativePathMethod::PENALTY;
+
+        else
+        {
+            if (alternative_path_method != "yen")
+                ROS_WARN("Unknown alternative_path_method \"%s\", using \"yen\"", alternative_path_method.c_str());
+
+            v_path.alternative_path_method = voronoi_path::AlternativePathMethod::YEN;
+        }
+
+        if (homotopy_invariant == "crossing_word")
+            v_path.homotopy_invariant = voronoi_path::HomotopyInvariant::CROSSING_WORD;
+
+        else
+        {
+            if (homotopy_invariant != "h_signature")
+                ROS_WARN("Unknown homotopy_invariant \"%s\", using \"h_signature\"", homotopy_invariant.c_str());
+
+            v_path.homotopy_invariant = voronoi_path::HomotopyInvariant::H_SIGNATURE;
+        }
 
         //Eband params
         nh.getParam("use_elastic_band", use_elastic_band);
+        nh.getParam("warm_start_elastic_band", warm_start_elastic_band);
         nh.getParam("num_optim_iterations", num_optim_iterations_);
         nh.getParam("max_recursion_depth_approx_equi", max_recursion_depth_approx_equi_); 
         nh.getParam("internal_force_gain", internal_force_gain_); 
@@ -718,8 +807,11 @@ namespace shared_voronoi_global_planner
         nh.getParam("equilibrium_relative_overshoot", equilibrium_relative_overshoot_); 
         nh.getParam("significant_force", significant_force_); 
         nh.getParam("costmap_weight", costmap_weight_); 
+        nh.getParam("jacobi_update", jacobi_update_);
+        nh.getParam("converge_on_residual", converge_on_residual_);
 
         v_path.use_elastic_band = use_elastic_band;
+        v_path.warm_start_elastic_band = warm_start_elastic_band;
         v_path.num_optim_iterations_ = num_optim_iterations_;
         v_path.internal_force_gain_ = internal_force_gain_;
         v_path.external_force_gain_ = external_force_gain_;
@@ -730,6 +822,8 @@ namespace shared_voronoi_global_planner
         v_path.equilibrium_relative_overshoot_ = equilibrium_relative_overshoot_;
         v_path.significant_force_ = significant_force_;
         v_path.costmap_weight_ = costmap_weight_;
+        v_path.jacobi_update_ = jacobi_update_;
+        v_path.converge_on_residual_ = converge_on_residual_;
         v_path.updateEBandParams();
     }
 } // namespace shared_voronoi_global_planner
@@ -32,7 +32,6 @@ double inflation_blur_radius = 0.125;
 bool publish_viz_paths = false;
 bool publish_path_names = true;
 int pixels_to_skip = 0;
-double open_cv_scale = 0.5;
 double h_class_threshold = 0.01;
 double min_node_sep_sq = 1.0;
 bool publish_all_path_markers = true;
@@ -49,6 +48,7 @@ double path_vertex_dist_threshold = 0.8;
 std::string base_link_frame = "base_link";
 double robot_radius = 0.3;
 bool use_elastic_band = true;
+bool warm_start_elastic_band = false;
 
 /**
  * Distance in meters before exhaustive path exploration terminates
@@ -65,4 +65,6 @@ double min_bubble_overlap_ = 0.9; ///<@brief minimum relative overlap two bubble
 int max_recursion_depth_approx_equi_ = 4; ///@brief maximum depth for recursive approximation to constrain computational burden
 double equilibrium_relative_overshoot_ = 0.75; ///@brief percentage of old force for which a new force is considered significant when higher as this value
 double significant_force_ = 0.15; ///@brief lower bound for absolute value of force below which it is treated as insignificant (no recursive approximation)
-double costmap_weight_ = 10.0; // the costmap weight or scaling factor
\ No newline at end of file
+double costmap_weight_ = 10.0; // the costmap weight or scaling factor
+bool jacobi_update_ = false;
+bool converge_on_residual_ = false;
\ No newline at end of file
@@ -23,7 +23,6 @@ bool readParams(ros::NodeHandle &nh)
 	nh.getParam("print_timings", print_timings);
 	nh.getParam("line_check_resolution", line_check_resolution);
 	nh.getParam("pixels_to_skip", pixels_to_skip);
-	nh.getParam("open_cv_scale", open_cv_scale);
 	nh.getParam("h_class_threshold", h_class_threshold);
 	nh.getParam("min_node_sep_sq", min_node_sep_sq);
 	nh.getParam("publish_all_path_markers", publish_all_path_markers);
@@ -42,6 +41,7 @@ bool readParams(ros::NodeHandle &nh)
 	nh.getParam("publish_viz_paths", publish_viz_paths);
 	nh.getParam("robot_radius", robot_radius);
 	nh.getParam("use_elastic_band", use_elastic_band);
+	nh.getParam("warm_start_elastic_band", warm_start_elastic_band);
 	nh.getParam("publish_path_names", publish_path_names);
 	nh.getParam("backtrack_plan_threshold", backtrack_plan_threshold);
 
@@ -53,12 +53,12 @@ bool readParams(ros::NodeHandle &nh)
 	v_path.min_node_sep_sq = min_node_sep_sq;
 	v_path.trimming_collision_threshold = trimming_collision_threshold;
 	v_path.search_radius = search_radius;
-	v_path.open_cv_scale = open_cv_scale;
 	v_path.pixels_to_skip = pixels_to_skip;
 	v_path.lonely_branch_dist_threshold = lonely_branch_dist_threshold;
 	v_path.path_waypoint_sep = path_waypoint_sep;
 	v_path.path_vertex_angle_threshold = path_vertex_angle_threshold;
 	v_path.use_elastic_band = use_elastic_band;
+	v_path.warm_start_elastic_band = warm_start_elastic_band;
 
 	//Elasitc band params
         nh.getParam("num_optim_iterations", num_optim_iterations_);
@@ -71,6 +71,8 @@ bool readParams(ros::NodeHandle &nh)
         nh.getParam("equilibrium_relative_overshoot", equilibrium_relative_overshoot_); 
         nh.getParam("significant_force", significant_force_); 
         nh.getParam("costmap_weight", costmap_weight_); 
+        nh.getParam("jacobi_update", jacobi_update_);
+        nh.getParam("converge_on_residual", converge_on_residual_);
         v_path.num_optim_iterations_ = num_optim_iterations_;
         v_path.internal_force_gain_ = internal_force_gain_;
         v_path.external_force_gain_ = external_force_gain_;
@@ -81,6 +83,8 @@ bool readParams(ros::NodeHandle &nh)
         v_path.equilibrium_relative_overshoot_ = equilibrium_relative_overshoot_;
         v_path.significant_force_ = significant_force_;
         v_path.costmap_weight_ = costmap_weight_;
+        v_path.jacobi_update_ = jacobi_update_;
+        v_path.converge_on_residual_ = converge_on_residual_;
 	v_path.updateEBandParams();
 
 	return true;
@@ -0,0 +1,202 @@
+#ifndef DISTANCE_FIELD_H_
+#define DISTANCE_FIELD_H_
+
+#include <vector>
+#include <cmath>
+#include <limits>
+#include <algorithm>
+
+/**
+ * Euclidean distance from every cell of an occupancy grid to the nearest occupied cell, in cells. Computed exactly in
+ * linear time using the lower envelope of parabolas (Felzenszwalb and Huttenlocher, "Distance Transforms of Sampled
+ * Functions"), first along columns then along rows. Only the distance is stored, its gradient is taken with central
+ * differences when distance and gradient are interpolated at a point
+ **/
+class DistanceField
+{
+public:
+	/**
+	 * Compute the distance field
+	 * @param data occupancy grid values, row major
+	 * @param _width width of grid in cells
+	 * @param _height height of grid in cells
+	 * @param threshold cells with values greater than this are occupied
+	 **/
+	void compute(const std::vector<signed char> &data, int _width, int _height, int threshold)
+	{
+		width = _width;
+		height = _height;
+		if (width <= 0 || height <= 0)
+		{
+			dist.clear();
+			return;
+		}
+
+		dist.resize(width * height);
+		for (int i = 0; i < width * height; ++i)
+			dist[i] = data[i] > threshold ? 0 : INF;
+
+		//Columns
+		std::vector<double> f(height), d(height);
+		for (int x = 0; x < width; ++x)
+		{
+			for (int y = 0; y < height; ++y)
+				f[y] = dist[x + y * width];
+
+			transform1D(f, d, height);
+			for (int y = 0; y < height; ++y)
+				dist[x + y * width] = d[y];
+		}
+
+		//Rows
+		f.resize(width);
+		d.resize(width);
+		for (int y = 0; y < height; ++y)
+		{
+			for (int x = 0; x < width; ++x)
+				f[x] = dist[x + y * width];
+
+			transform1D(f, d, width);
+			for (int x = 0; x < width; ++x)
+				dist[x + y * width] = std::sqrt(d[x]);
+		}
+	}
+
+	/**
+	 * @param x x coordinate in cells
+	 * @param y y coordinate in cells
+	 * @return distance from cell containing (x, y) to nearest occupied cell in cells, 0 outside the grid and infinity
+	 * if there are no occupied cells
+	 **/
+	double getDistance(double x, double y) const
+	{
+		int cell_x = std::floor(x);
+		int cell_y = std::floor(y);
+		if (cell_x < 0 || cell_y < 0 || cell_x >= width || cell_y >= height)
+			return 0;
+
+		double value = dist[cell_x + cell_y * width];
+		return value >= MAX_DIST ? std::numeric_limits<double>::infinity() : value;
+	}
+
+	/**
+	 * Distance and gradient bilinearly interpolated between the centers of the 4 closest cells. Points outside the
+	 * grid take the values at the nearest border
+	 * @param x x coordinate in cells
+	 * @param y y coordinate in cells
+	 * @param distance interpolated distance to nearest occupied cell in cells
+	 * @param grad_x interpolated derivative of distance in x
+	 * @param grad_y interpolated derivative of distance in y
+	 * @return false if the field has not been computed
+	 **/
+	bool getInterpolated(double x, double y, double &distance, double &grad_x, double &grad_y) const
+	{
+		if (dist.empty())
+			return false;
+
+		//Cell centers are at integer + 0.5
+		double u = std::min(std::max(x - 0.5, 0.0), width - 1.0);
+		double v = std::min(std::max(y - 0.5, 0.0), height - 1.0);
+		int x0 = std::min(static_cast<int>(u), width - 2 > 0 ? width - 2 : 0);
+		int y0 = std::min(static_cast<int>(v), height - 2 > 0 ? height - 2 : 0);
+		int x1 = std::min(x0 + 1, width - 1);
+		int y1 = std::min(y0 + 1, height - 1);
+		double fx = u - x0;
+		double fy = v - y0;
+
+		double w00 = (1 - fx) * (1 - fy);
+		double w10 = fx * (1 - fy);
+		double w01 = (1 - fx) * fy;
+		double w11 = fx * fy;
+		double gx00, gy00, gx10, gy10, gx01, gy01, gx11, gy11;
+		gradient(x0, y0, gx00, gy00);
+		gradient(x1, y0, gx10, gy10);
+		gradient(x0, y1, gx01, gy01);
+		gradient(x1, y1, gx11, gy11);
+
+		distance = w00 * dist[x0 + y0 * width] + w10 * dist[x1 + y0 * width] + w01 * dist[x0 + y1 * width] + w11 * dist[x1 + y1 * width];
+		grad_x = w00 * gx00 + w10 * gx10 + w01 * gx01 + w11 * gx11;
+		grad_y = w00 * gy00 + w10 * gy10 + w01 * gy01 + w11 * gy11;
+		return true;
+	}
+
+	/**
+	 * @return whether the field was computed for a grid of this size
+	 **/
+	bool matches(int _width, int _height) const
+	{
+		return width == _width && height == _height && !dist.empty();
+	}
+
+private:
+	/**
+	 * Stand in for infinity that stays finite when parabolas are intersected
+	 **/
+	static constexpr double INF = 1e20;
+
+	/**
+	 * Distance stored for cells when there are no occupied cells, square root of INF
+	 **/
+	static constexpr double MAX_DIST = 1e10;
+
+	/**
+	 * Distance of every cell to the nearest occupied cell in cells, row major
+	 **/
+	std::vector<double> dist;
+	int width = 0;
+	int height = 0;
+
+	/**
+	 * Gradient of the distance at a cell by central differences, one sided at the borders of the grid
+	 **/
+	void gradient(int x, int y, double &grad_x, double &grad_y) const
+	{
+		int left = std::max(x - 1, 0);
+		int right = std::min(x + 1, width - 1);
+		int down = std::max(y - 1, 0);
+		int up = std::min(y + 1, height - 1);
+
+		grad_x = right > left ? (dist[right + y * width] - dist[left + y * width]) / (right - left) : 0;
+		grad_y = up > down ? (dist[x + up * width] - dist[x + down * width]) / (up - down) : 0;
+	}
+
+	/**
+	 * 1D squared distance transform of sampled function f of length n into d
+	 **/
+	static void transform1D(const std::vector<double> &f, std::vector<double> &d, int n)
+	{
+		std::vector<int> v(n);
+		std::vector<double> z(n + 1);
+		int k = 0;
+		v[0] = 0;
+		z[0] = -INF;
+		z[1] = INF;
+
+		//Lower envelope of parabolas rooted at every sample
+		for (int q = 1; q < n; ++q)
+		{
+			double s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+			while (s <= z[k])
+			{
+				--k;
+				s = ((f[q] + q * q) - (f[v[k]] + v[k] * v[k])) / (2.0 * q - 2.0 * v[k]);
+			}
+
+			++k;
+			v[k] = q;
+			z[k] = s;
+			z[k + 1] = INF;
+		}
+
+		k = 0;
+		for (int q = 0; q < n; ++q)
+		{
+			while (z[k + 1] < q)
+				++k;
+
+			d[q] = (q - v[k]) * (q - v[k]) + f[v[k]];
+		}
+	}
+};
+
+#endif
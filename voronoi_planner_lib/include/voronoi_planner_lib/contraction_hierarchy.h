@@ -0,0 +1,86 @@
+#ifndef CONTRACTION_HIERARCHY_H_
+#define CONTRACTION_HIERARCHY_H_
+
+#include <voronoi_msgs_and_types/graph_node.h>
+#include <vector>
+
+namespace voronoi_path
+{
+    /**
+     * Contraction hierarchy built on top of the voronoi adjacency list. Nodes are contracted in order of edge difference and
+     * shortcuts are added between neighbors of contracted nodes when no witness path exists. Queries are bidirectional Dijkstra
+     * searches on the upward graph, and shortcuts are unpacked so that returned paths contain the original node sequence
+     **/
+    class ContractionHierarchy
+    {
+    public:
+        /**
+         * Build the hierarchy. Edge weights are Euclidean distances between nodes
+         * @param adj_list adjacency list of graph, entries of -1 are ignored
+         * @param node_inf pixel coordinates of all nodes
+         **/
+        void build(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf);
+
+        /**
+         * Find shortest path between 2 nodes using the hierarchy
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param path shortest path that was found, with all shortcuts unpacked
+         * @return boolean indicating success
+         **/
+        bool query(const int &start_node, const int &end_node, std::vector<int> &path) const;
+
+        /**
+         * Remove the hierarchy, isBuilt() will return false until build is called again
+         **/
+        void clear();
+
+        /**
+         * @return whether the hierarchy has been built
+         **/
+        bool isBuilt() const;
+
+        /**
+         * Maximum number of nodes settled during each witness search. Lower values speed up preprocessing but add
+         * more unnecessary shortcuts
+         **/
+        int witness_settle_limit = 64;
+
+    private:
+        /**
+         * Edge in upward graph. middle is the contracted node that a shortcut bypasses, -1 for original edges
+         **/
+        struct Edge
+        {
+            int to;
+            double weight;
+            int middle;
+        };
+
+        /**
+         * Upward graph, up_edges[i] only contains edges to nodes of higher rank than i
+         **/
+        std::vector<std::vector<Edge>> up_edges;
+
+        /**
+         * Contraction order of each node
+         **/
+        std::vector<int> rank;
+
+        /**
+         * Recursively unpack an edge of the hierarchy into original nodes, from is not added to path
+         * @param from node number of edge's first node
+         * @param to node number of edge's second node
+         * @param middle middle node of edge, -1 if edge is an original edge
+         * @param path path to append the unpacked nodes to
+         **/
+        void unpackEdge(const int &from, const int &to, const int &middle, std::vector<int> &path) const;
+
+        /**
+         * Get middle node of the edge between 2 nodes from the upward graph of the lower ranked node
+         **/
+        int getMiddle(const int &a, const int &b) const;
+    };
+} // namespace voronoi_path
+
+#endif
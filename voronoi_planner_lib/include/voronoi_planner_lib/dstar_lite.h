@@ -0,0 +1,102 @@
+#ifndef DSTAR_LITE_H_
+#define DSTAR_LITE_H_
+
+#include <voronoi_msgs_and_types/graph_node.h>
+#include <vector>
+#include <set>
+#include <utility>
+#include <cstdint>
+
+namespace voronoi_path
+{
+    /**
+     * D* Lite incremental search on the voronoi graph. The search tree is rooted at the goal, so that start movement only
+     * requires the key modifier to be updated, and only vertices affected by changes in the graph are repaired.
+     * Edge costs are Euclidean distances between nodes
+     **/
+    class DStarLite
+    {
+    public:
+        /**
+         * Discard the previous search tree and start a new search
+         * @param adj_list adjacency list of graph, entries of -1 are ignored
+         * @param node_inf pixel coordinates of all nodes
+         * @param start_node node number of starting node
+         * @param goal_node node number of goal node
+         **/
+        void reset(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf, const int &start_node, const int &goal_node);
+
+        /**
+         * Replace the graph with a newly generated one. Nodes are matched to the previous graph by pixel coordinates, the search
+         * tree is carried over and only nodes whose edges changed are updated. If the goal no longer exists, the engine is
+         * uninitialized and reset must be called again
+         * @param adj_list adjacency list of new graph
+         * @param node_inf pixel coordinates of all nodes of new graph
+         **/
+        void updateGraph(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf);
+
+        /**
+         * Move the start of the search
+         * @param start_node node number of new starting node
+         **/
+        void updateStart(const int &start_node);
+
+        /**
+         * Repair the search tree and extract the shortest path from start to goal
+         * @param path shortest path that was found
+         * @return boolean indicating success
+         **/
+        bool computeShortestPath(std::vector<int> &path);
+
+        /**
+         * @return whether a search tree exists
+         **/
+        bool isInitialized() const;
+
+        /**
+         * @return node number of goal node in the current graph
+         **/
+        int getGoal() const;
+
+        /**
+         * @return number of vertices expanded during the last computeShortestPath call
+         **/
+        int getExpansions() const;
+
+    private:
+        typedef std::pair<double, double> Key;
+
+        std::vector<std::vector<int>> adj;
+        std::vector<GraphNode> nodes;
+        std::vector<double> g;
+        std::vector<double> rhs;
+
+        /**
+         * Key each node is currently queued with, only valid if in_open is true
+         **/
+        std::vector<Key> open_key;
+        std::vector<bool> in_open;
+        std::set<std::pair<Key, int>> open_list;
+
+        int start = -1;
+        int goal = -1;
+        int last_start = -1;
+        double km = 0;
+        int expansions = 0;
+        bool initialized = false;
+
+        double cost(const int &a, const int &b) const;
+        double heuristic(const int &a, const int &b) const;
+        Key calculateKey(const int &node) const;
+        void updateVertex(const int &node);
+        void insertOpen(const int &node);
+        void removeOpen(const int &node);
+
+        /**
+         * Same discretization as VoronoiPath::hash, nodes within the same pixel are the same node
+         **/
+        static uint32_t nodeKey(const GraphNode &node);
+    };
+} // namespace voronoi_path
+
+#endif
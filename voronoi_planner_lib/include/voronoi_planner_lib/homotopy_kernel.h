@@ -0,0 +1,109 @@
+#ifndef HOMOTOPY_KERNEL_H_
+#define HOMOTOPY_KERNEL_H_
+
+#include <vector>
+#include <complex>
+#include <cstdint>
+
+namespace voronoi_path
+{
+    /**
+     * Homotopy class of a path. Only the members of the invariant in use are filled in
+     * h_signature: complex H-signature, compared with a relative threshold
+     * word: freely reduced sequence of signed obstacle ray crossings, letter +(j + 1) is a left to right crossing of the
+     * ray of obstacle j and -(j + 1) a right to left crossing
+     * hash: hash of word, paths are in the same class if hashes are equal
+     **/
+    struct HomotopyClass
+    {
+        std::complex<double> h_signature = std::complex<double>(0, 0);
+        std::vector<int> word;
+        uint64_t hash = 0;
+    };
+
+    /**
+     * Structure of arrays copy of obstacle centroids and their coefficients for computing H-signature contributions of
+     * edges. The loop over obstacles is written without branches or calls into libm, using polynomial log and atan2
+     * approximations, so that the compiler can vectorize it. Obstacles are padded to a multiple of the lane count with
+     * far away dummy obstacles that have a coefficient of 0.
+     *
+     * Also provides the crossing word invariant. Every obstacle gets a reference ray pointing in +y from its center, and
+     * segments are tested against the rays in fixed point integer arithmetic, so results are exact and do not depend on
+     * the number of obstacles
+     **/
+    class HomotopyKernel
+    {
+    public:
+        /**
+         * Number of independent accumulators, obstacle arrays are padded to a multiple of this
+         **/
+        static constexpr int LANES = 4;
+
+        /**
+         * Copy obstacles into the structure of arrays layout, must be called whenever centers or coefficients change
+         * @param centers centers of obstacles in complex form
+         * @param coeff precomputed coefficients of each obstacle, same size as centers
+         * @return whether the obstacles are different from the previous call
+         **/
+        bool setObstacles(const std::vector<std::complex<double>> &centers, const std::vector<std::complex<double>> &coeff);
+
+        /**
+         * Calculate homotopy value of a single straight line edge, approximately equal to summing
+         * (log(to - c) - log(from - c)) * coeff over all obstacles with the angle difference wrapped to [-pi, pi]
+         * @param from starting point of edge
+         * @param to ending point of edge
+         * @return homotopy value of the edge
+         **/
+        std::complex<double> edgeValue(const std::complex<double> &from, const std::complex<double> &to) const;
+
+        /**
+         * Append the ray crossings of a single straight line edge, in the order they are crossed. The crossings of the
+         * reversed edge are always the inverse of the crossings of the edge
+         * @param from starting point of edge
+         * @param to ending point of edge
+         * @param letters crossings are appended to this
+         **/
+        void edgeCrossings(const std::complex<double> &from, const std::complex<double> &to, std::vector<int> &letters) const;
+
+        /**
+         * Concatenate letters to a reduced word, cancelling every letter that is followed by its inverse
+         * @param word reduced word to append to
+         * @param letters letters to append, in order
+         **/
+        static void appendReduced(std::vector<int> &word, const std::vector<int> &letters);
+
+        /**
+         * @param word reduced word
+         * @return 64 bit FNV-1a hash of word
+         **/
+        static uint64_t wordHash(const std::vector<int> &word);
+
+        /**
+         * @return number of obstacles, not including padding
+         **/
+        int size() const;
+
+    private:
+        /**
+         * Coordinates are multiplied by this before being rounded for the integer crossing tests
+         **/
+        static constexpr double FIXED_POINT_SCALE = 16.0;
+
+        static int64_t toFixedPoint(const double &value);
+
+        /**
+         * Fixed point obstacle centers sorted by x then by obstacle number, and the obstacle number of each
+         **/
+        std::vector<int64_t> ray_x;
+        std::vector<int64_t> ray_y;
+        std::vector<int> ray_obstacle;
+
+        std::vector<double> center_x;
+        std::vector<double> center_y;
+        std::vector<double> coeff_re;
+        std::vector<double> coeff_im;
+        int num_obstacles = 0;
+    };
+} // namespace voronoi_path
+
+#endif
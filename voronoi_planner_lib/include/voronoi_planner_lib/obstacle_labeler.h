@@ -0,0 +1,157 @@
+#ifndef OBSTACLE_LABELER_H_
+#define OBSTACLE_LABELER_H_
+
+#include <vector>
+#include <utility>
+
+namespace voronoi_path
+{
+    /**
+     * 8-connected component labeling of the cells of an occupancy grid with values above a threshold. Each component
+     * keeps one representative cell, the cell with the highest value, which lies inside the obstacle and is used as the
+     * obstacle's point for homotopy class calculations. Supports incremental updates, where only components touching
+     * cells whose occupancy changed are relabeled
+     **/
+    class ObstacleLabeler
+    {
+    public:
+        /**
+         * Connected group of occupied cells
+         **/
+        struct Component
+        {
+            /**
+             * Label of the component's cells
+             **/
+            int label = -1;
+
+            /**
+             * Cell index (x + y * width) of the highest valued cell of the component
+             **/
+            int representative = -1;
+
+            /**
+             * Number of cells in the component
+             **/
+            int area = 0;
+
+            /**
+             * Inclusive bounding box of the component in cells
+             **/
+            int min_x = 0;
+            int min_y = 0;
+            int max_x = 0;
+            int max_y = 0;
+        };
+
+        /**
+         * Label the whole grid, discarding previous results
+         * @param data occupancy grid values, row major
+         * @param width width of grid in cells
+         * @param height height of grid in cells
+         * @param threshold cells with values greater than this are occupied
+         **/
+        void label(const std::vector<signed char> &data, const int &width, const int &height, const int &threshold);
+
+        /**
+         * Relabel only components that touch cells whose occupancy changed since the last call. Falls back to label
+         * if the grid size or threshold changed, or nothing has been labeled yet
+         * @param data occupancy grid values, row major
+         * @param width width of grid in cells
+         * @param height height of grid in cells
+         * @param threshold cells with values greater than this are occupied
+         **/
+        void update(const std::vector<signed char> &data, const int &width, const int &height, const int &threshold);
+
+        /**
+         * @param components all current components, in order of their label
+         **/
+        void getComponents(std::vector<Component> &components) const;
+
+        /**
+         * Find pairs of components separated by at most max_gap free cells, by growing all components into free space
+         * at the same time (8-connected) until the fronts meet. Meetings are kept between calls, only the area around
+         * components that were relabeled since the last call is grown again
+         * @param max_gap maximum number of free cells between 2 components
+         * @param pairs labels of components that are close to each other, smaller label first, without duplicates
+         **/
+        void findNearbyPairs(const int &max_gap, std::vector<std::pair<int, int>> &pairs);
+
+        /**
+         * @return number of cells that were flood filled during the last label or update call
+         **/
+        int getRelabeledCells() const;
+
+    private:
+        std::vector<unsigned char> occupied;
+
+        /**
+         * Component label of every cell, -1 for free cells
+         **/
+        std::vector<int> labels;
+
+        /**
+         * Components indexed by label, removed components have a representative of -1 and their labels are reused
+         **/
+        std::vector<Component> components;
+        std::vector<int> free_labels;
+
+        /**
+         * Scratch queue for flood fills
+         **/
+        std::vector<int> queue;
+
+        /**
+         * Cell where the fronts of 2 components met during findNearbyPairs, smaller label first
+         **/
+        struct Meeting
+        {
+            int first;
+            int second;
+            int cell;
+        };
+
+        std::vector<Meeting> meetings;
+        int meetings_gap = -1;
+
+        /**
+         * Inclusive bounding box of all components relabeled since the last findNearbyPairs call, empty if min > max.
+         * all_dirty is set when the whole grid was labeled
+         **/
+        int dirty_min_x = 0;
+        int dirty_min_y = 0;
+        int dirty_max_x = -1;
+        int dirty_max_y = -1;
+        bool all_dirty = true;
+
+        /**
+         * Scratch buffers of findNearbyPairs, sized to the grown window
+         **/
+        std::vector<int> owner;
+        std::vector<int> dist;
+        std::vector<int> frontier;
+
+        int width = 0;
+        int height = 0;
+        int threshold = 0;
+        int relabeled_cells = 0;
+        bool initialized = false;
+
+        /**
+         * Flood fill the free component containing seed with a new label
+         **/
+        void floodFill(const std::vector<signed char> &data, const int &seed);
+
+        /**
+         * Remove the labels of all cells of a component, and append the cells to cells
+         **/
+        void clearComponent(const int &label, std::vector<int> &cells);
+
+        /**
+         * Grow the dirty bounding box to contain a component
+         **/
+        void markDirty(const Component &component);
+    };
+} // namespace voronoi_path
+
+#endif
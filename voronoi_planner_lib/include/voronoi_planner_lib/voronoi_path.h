@@ -13,13 +13,19 @@
 #include "jc_voronoi_clip.h"
 #include <voronoi_msgs_and_types/graph_node.h>
 #include <voronoi_msgs_and_types/map.h>
+#include <voronoi_msgs_and_types/distance_field.h>
 #include <eband_optimizer/eband_optimizer.h>
+#include <voronoi_planner_lib/contraction_hierarchy.h>
+#include <voronoi_planner_lib/dstar_lite.h>
+#include <voronoi_planner_lib/homotopy_kernel.h>
+#include <voronoi_planner_lib/obstacle_labeler.h>
 #include <chrono>
 #include <limits>
 #include <cmath>
 #include <vector>
 #include <string>
 #include <map>
+#include <unordered_map>
 #include <complex>
 #include <mutex>
 #include <memory>
@@ -37,6 +43,14 @@ namespace voronoi_path
         uint32_t id;
         std::vector<GraphNode> path;
 
+        /**
+         * Cached homotopy class of path. Only valid if h_class_version matches the obstacle version of the VoronoiPath
+         * object and h_class_path is the same as path, see VoronoiPath::getPathHomotopyClass
+         **/
+        HomotopyClass h_class;
+        int h_class_version = -1;
+        std::vector<GraphNode> h_class_path;
+
         //Constructors
         Path() : id(-1){}
         Path(uint32_t _id, std::vector<GraphNode> && in_path)
@@ -47,21 +61,162 @@ namespace voronoi_path
     };
 
     /**
-     * Structure definition for use during A* search algorithm only
-     * Contains the information required for path searching
+     * Direction of A* searches
+     * AUTO: bidirectional if start and end are further apart than VoronoiPath::bidirectional_search_threshold
+     * UNIDIRECTIONAL: A* from start to end
+     * BIDIRECTIONAL: A* from both start and end with average potentials, meeting in between
      **/
-    struct NodeInfo
+    enum class SearchMode
     {
-        double cost_upto_here;
-        double cost_to_goal;
-        double total_cost;
+        AUTO,
+        UNIDIRECTIONAL,
+        BIDIRECTIONAL
+    };
+
+    /**
+     * Scratch space for A* searches. Only entries touched by the previous search are reset, so one workspace can be reused
+     * for many searches on the same graph without reallocating. Each thread must use its own workspace
+     **/
+    struct SearchWorkspace
+    {
+        //Forward search from start
+        std::vector<double> cost_upto_here;
+        std::vector<int> prev;
+        std::vector<bool> closed;
+
+        //Backward search from end, only used by bidirectional search
+        std::vector<double> cost_to_end;
+        std::vector<int> next;
+        std::vector<bool> closed_reverse;
 
-        void updateCost()
+        std::vector<int> touched;
+
+        /**
+         * Direction of searches done with this workspace
+         **/
+        SearchMode mode = SearchMode::AUTO;
+
+        /**
+         * Reset workspace for a new search on a graph with num_nodes nodes
+         **/
+        void prepare(const int &num_nodes)
         {
-            total_cost = cost_upto_here + cost_to_goal;
+            if (cost_upto_here.size() != num_nodes)
+            {
+                cost_upto_here.assign(num_nodes, std::numeric_limits<double>::infinity());
+                prev.assign(num_nodes, -1);
+                closed.assign(num_nodes, false);
+                cost_to_end.assign(num_nodes, std::numeric_limits<double>::infinity());
+                next.assign(num_nodes, -1);
+                closed_reverse.assign(num_nodes, false);
+            }
+
+            else
+            {
+                for (const auto &node : touched)
+                {
+                    cost_upto_here[node] = std::numeric_limits<double>::infinity();
+                    prev[node] = -1;
+                    closed[node] = false;
+                    cost_to_end[node] = std::numeric_limits<double>::infinity();
+                    next[node] = -1;
+                    closed_reverse[node] = false;
+                }
+            }
+
+            touched.clear();
         }
     };
 
+    /**
+     * State of Yen's algorithm for one start and end node pair. Kept between calls so that a search which ran out of time can
+     * continue from the spur node it stopped at
+     **/
+    struct YenState
+    {
+        int start_node = -1;
+        int end_node = -1;
+
+        /**
+         * Graph version the state was computed on, state is invalid once the graph is regenerated
+         **/
+        int graph_version = -1;
+
+        std::vector<std::vector<int>> kthPaths;
+        std::vector<std::pair<double, std::vector<int>>> potentialKth;
+        std::vector<HomotopyClass> homotopy_classes;
+        std::unordered_map<uint64_t, std::vector<std::vector<int>>> seen_paths;
+
+        /**
+         * Index of the next spur node in the latest accepted path
+         **/
+        int spur_index = 0;
+
+        /**
+         * Flag indicating that no more paths in distinct homotopy classes can be found
+         **/
+        bool exhausted = false;
+    };
+
+    /**
+     * Group of obstacles that are represented by a single point when calculating homotopy classes
+     **/
+    struct ObstacleCluster
+    {
+        /**
+         * Point used for homotopy classes, the point of the largest obstacle in the cluster
+         **/
+        GraphNode representative;
+
+        /**
+         * Points of all obstacles merged into this cluster, including the representative
+         **/
+        std::vector<GraphNode> members;
+
+        /**
+         * Total number of occupied cells of all members
+         **/
+        int area = 0;
+
+        /**
+         * False if the cluster was left out because of max_homotopy_obstacles
+         **/
+        bool kept = true;
+    };
+
+    /**
+     * Single independent request for VoronoiPath::getPathsBatch
+     **/
+    struct PathQuery
+    {
+        GraphNode start;
+        GraphNode end;
+        int num_paths = 1;
+        SearchMode search_mode = SearchMode::AUTO;
+    };
+
+    /**
+     * Methods available for finding alternative paths after the shortest path has been found
+     * YEN: Yen's kth shortest paths algorithm, candidates are filtered by homotopy class
+     * PENALTY: weights of edges used by previously found paths are inflated and the graph is searched again
+     **/
+    enum class AlternativePathMethod
+    {
+        YEN,
+        PENALTY
+    };
+
+    /**
+     * Invariants available for deciding whether paths are in the same homotopy class
+     * H_SIGNATURE: complex H-signature, compared using h_class_threshold
+     * CROSSING_WORD: reduced sequence of signed crossings of obstacle reference rays, compared by hash
+     **/
+    enum class HomotopyInvariant
+    {
+        H_SIGNATURE,
+        CROSSING_WORD
+    };
+
     class VoronoiPath
     {
     public:
@@ -74,6 +229,9 @@ namespace voronoi_path
          **/
         bool getEdges(std::vector<GraphNode> &edges);
 
+        /**
+         * Elastic band optimizer holding the eband parameters, copied for every group of paths that is optimized
+         **/
         eband_optimizer::EBandOptimizer ebo;
 
         /**
@@ -90,6 +248,20 @@ namespace voronoi_path
          **/
         bool getObstacleCentroids(std::vector<GraphNode> &centroids);
 
+        /**
+         * Get obstacle clusters of the current graph, showing which obstacles were merged or left out
+         * @param clusters vector passed by reference to store the clusters
+         * @return boolean indicating success
+         **/
+        bool getObstacleClusters(std::vector<ObstacleCluster> &clusters);
+
+        /**
+         * Set robot position used to rank obstacles when obstacle_rank_by_robot_distance is true. Takes effect on the next
+         * map update
+         * @param position robot position in pixels wrt global map origin
+         **/
+        void setRobotPosition(const GraphNode &position);
+
         /**
          * Get the costs of all paths 
          * @return vector containing all the costs
@@ -135,6 +307,40 @@ namespace voronoi_path
          **/
         std::vector<Path> getPath(const GraphNode &start, const GraphNode &end, const int &num_paths);
 
+        /**
+         * Anytime version of getPath. The shortest path is always returned, alternative paths are added until the time budget
+         * runs out. When using Yen's algorithm, the search state is kept so that the next call with the same start and end
+         * nodes on the same graph continues where this call stopped
+         * @param start start position, in pixels wrt global map origin
+         * @param end end position, in pixels wrt to global map origin
+         * @param num_paths total number of paths to find
+         * @param time_budget time in seconds allowed for finding alternative paths, <= 0 for no limit. Starts once the graph is no longer being updated
+         * @param partial set to true if the time budget ran out before all num_paths paths were found
+         * @return vector containing all the paths found
+         **/
+        std::vector<Path> getPath(const GraphNode &start, const GraphNode &end, const int &num_paths, const double &time_budget, bool &partial);
+
+        /**
+         * Find num_paths paths from one start to each of several goals. A single shortest path tree is grown from the start until
+         * all goals are reached, which replaces one shortest path search per goal. Alternative paths for each goal are still
+         * found separately using alternative_path_method, as their searches run on graphs with edges removed or penalized
+         * where the tree does not hold. Does not modify the previous paths used by replan
+         * @param start start position, in pixels wrt global map origin
+         * @param goals goal positions, in pixels wrt to global map origin
+         * @param num_paths total number of paths to find for each goal
+         * @return paths found for each goal, in the same order as goals. Empty for goals that could not be reached
+         **/
+        std::vector<std::vector<Path>> getPaths(const GraphNode &start, const std::vector<GraphNode> &goals, const int &num_paths);
+
+        /**
+         * Run many independent queries in parallel against the current graph. The graph is locked for reading for the duration
+         * of the batch, and every worker thread uses its own search scratch space. Does not modify the previous paths used by
+         * replan, and does not use the incremental search
+         * @param queries start, end and number of paths of every query, positions are in pixels wrt global map origin
+         * @return paths found for each query, in the same order as queries. Empty for queries that failed
+         **/
+        std::vector<std::vector<Path>> getPathsBatch(const std::vector<PathQuery> &queries);
+
         /**
          * Alternate planning method using robot's current position and backtracking to find all paths that emanate from robot position.
          * Path lengths are limited to certain threshold
@@ -221,10 +427,32 @@ namespace voronoi_path
         int pixels_to_skip = 0;
 
         /**
-         * Downscale factor used for scaling map before finding contours. Smaller values increase speed (possibly marginal)
-         * but may decrease the accuracy of the centroids found
+         * Only relabel obstacles that touch cells whose occupancy changed since the previous map, instead of labeling the
+         * whole map on every update
+         **/
+        bool incremental_obstacle_labeling = false;
+
+        /**
+         * Obstacles separated by at most this number of free pixels are merged into one obstacle for homotopy classes.
+         * 0 disables merging
          **/
-        double open_cv_scale = 0.25;
+        int obstacle_merge_gap = 0;
+
+        /**
+         * Obstacle clusters with fewer occupied pixels than this are merged into the nearest larger cluster. 0 disables merging
+         **/
+        int obstacle_merge_area = 0;
+
+        /**
+         * Maximum number of obstacle clusters used for homotopy classes, the rest are left out. 0 means no limit
+         **/
+        int max_homotopy_obstacles = 0;
+
+        /**
+         * Rank clusters by distance to the position given to setRobotPosition instead of by area when applying
+         * max_homotopy_obstacles
+         **/
+        bool obstacle_rank_by_robot_distance = false;
 
         /**
          * Percentage threshold to classify a homotopy class as same or different. Ideally, same homotopy classes should have identical 
@@ -233,6 +461,12 @@ namespace voronoi_path
          **/
         double h_class_threshold = 0.01;
 
+        /**
+         * Invariant used to compare homotopy classes of paths. CROSSING_WORD is exact and does not use obs_coeff, so it does not
+         * suffer from overflow or NaN with many obstacles
+         **/
+        HomotopyInvariant homotopy_invariant = HomotopyInvariant::H_SIGNATURE;
+
         /**
          * Minimum separation between nodes. If nodes are less than this value (m) apart, they will be cleaned up
          **/
@@ -273,6 +507,52 @@ namespace voronoi_path
          **/
         int node_depth_threshold = 5; 
 
+        /**
+         * Method used by getPath to find alternative paths in distinct homotopy classes
+         **/
+        AlternativePathMethod alternative_path_method = AlternativePathMethod::YEN;
+
+        /**
+         * Factor to multiply the weight of an edge with every time it is used by a path found by the penalty method. Must be > 1
+         **/
+        double penalty_factor = 1.5;
+
+        /**
+         * Maximum number of searches done by the penalty method before it stops looking for more paths in distinct homotopy classes
+         **/
+        int penalty_max_iterations = 20;
+
+        /**
+         * Number of landmarks to select during mapToGraph for the ALT (A*, landmarks, triangle inequality) heuristic. Graph
+         * distances from every landmark to every node are precomputed, which tightens the A* heuristic in maze-like maps.
+         * Set to 0 to use the Euclidean distance heuristic only
+         **/
+        int num_landmarks = 0;
+
+        /**
+         * Build a contraction hierarchy during mapToGraph, used by findShortestPath for queries on the unmodified graph.
+         * Preprocessing is expensive, only enable when the global map is static and the graph is rarely rebuilt
+         **/
+        bool use_contraction_hierarchy = false;
+
+        /**
+         * Use D* Lite to find the shortest path in getPath. The search tree for the current goal is kept between calls and
+         * repaired when the robot moves or the graph is regenerated, instead of searching from scratch
+         **/
+        bool use_incremental_search = false;
+
+        /**
+         * Time budget in seconds for finding alternative paths during replan's exploration for new homotopy classes. Unfinished
+         * searches continue in the next replan. Set to 0 for no limit
+         **/
+        double planning_time_budget = 0;
+
+        /**
+         * Distance in meters between start and end nodes above which searches in SearchMode::AUTO are bidirectional.
+         * Set to 0 to always search from start only
+         **/
+        double bidirectional_search_threshold = 0;
+
         // /**
         //  * Threshold distance in meters for last branch in order for deadend path to be considered
         //  **/
@@ -283,6 +563,13 @@ namespace voronoi_path
          **/
         bool use_elastic_band = true;
 
+        /**
+         * Keep the optimized elastic band of every path by path id, and start from it when the path is optimized again
+         * while replanning, as long as the path still follows the band. The band is reconnected to the robot and the goal,
+         * and only the reconnected parts are optimized, together with bubbles whose distance to obstacles changed
+         **/
+        bool warm_start_elastic_band = false;
+
         /**
          * Robot radius required for elastic band path smoothing
          **/
@@ -299,6 +586,8 @@ namespace voronoi_path
         double equilibrium_relative_overshoot_ = 0.75; ///@brief percentage of old force for which a new force is considered significant when higher as this value
         double significant_force_ = 0.15; ///@brief lower bound for absolute value of force below which it is treated as insignificant (no recursive approximation)
         double costmap_weight_ = 10.0; // the costmap weight or scaling factor
+        bool jacobi_update_ = false; ///<@brief move all bubbles of the band at once from the forces of the last iteration
+        bool converge_on_residual_ = false; ///<@brief freeze bubbles whose force fell below significant_force_ and stop optimizing once all bubbles are frozen
 
     private:
         /**
@@ -359,11 +648,69 @@ namespace voronoi_path
          **/
         std::vector<std::complex<double>> obs_coeff;
 
+        /**
+         * Structure of arrays copy of centers and obs_coeff used to compute edge homotopy values
+         **/
+        HomotopyKernel homotopy_kernel;
+
+        /**
+         * Increased every time the obstacles used for homotopy classes change, invalidates classes cached in paths
+         **/
+        int homotopy_version = 0;
+
+        /**
+         * Connected components of obstacles in the map, kept between map updates for incremental labeling
+         **/
+        ObstacleLabeler obstacle_labeler;
+
+        /**
+         * Distance of every cell to the nearest cell above trimming_collision_threshold, gives the clearance of the
+         * corridor around a path during contraction
+         **/
+        DistanceField distance_field;
+
+        /**
+         * Obstacle clusters found during the last map update, centers contains the representatives of kept clusters
+         **/
+        std::vector<ObstacleCluster> obstacle_clusters;
+
+        GraphNode robot_position;
+        bool robot_position_set = false;
+        std::mutex robot_position_mtx;
+
+        /**
+         * Homotopy class contribution of every edge, same layout as adj_list. ie edge_h_signature[i][j] is the contribution
+         * of the edge from node i to adj_list[i][j]. Computed after every graph update
+         **/
+        std::vector<std::vector<std::complex<double>>> edge_h_signature;
+
+        /**
+         * Ray crossings of every edge, same layout as adj_list. Computed after every graph update when homotopy_invariant is
+         * CROSSING_WORD, empty otherwise
+         **/
+        std::vector<std::vector<std::vector<int>>> edge_crossing_word;
+
         /**
          * Stores total number of nodes, ie adj_list.size()
          **/
         int num_nodes = 0;
 
+        /**
+         * Exact graph distances in pixels from each landmark to every node, computed during mapToGraph.
+         * ie. landmark_dists[l][i] is the distance from landmark l to node i, infinity if unreachable
+         **/
+        std::vector<std::vector<double>> landmark_dists;
+
+        /**
+         * Contraction hierarchy of adj_list, only built if use_contraction_hierarchy is true
+         **/
+        ContractionHierarchy contraction_hierarchy;
+
+        /**
+         * Incremental search engine, keeps the search tree of the current goal when use_incremental_search is true
+         **/
+        DStarLite incremental_search;
+
         /**
          * Max number of nodes that can be used to generate a bezier subsection. 26 choose 13 is 10400600. Higher
          * values increases the likelihood of integer overflow
@@ -386,9 +733,21 @@ namespace voronoi_path
         std::vector<double> previous_path_costs;
 
         /**
-         * Flag to indicate whether paths were received from backtrackPlan or getPath
+         * Incremented every time the graph is regenerated in mapToGraph
+         **/
+        int graph_version = 0;
+
+        /**
+         * Yen's algorithm state of the last getPath call, continued by the next call if start, end and graph are unchanged
          **/
-        bool backtrack_paths = false;
+        YenState yen_state;
+
+        /**
+         * Optimized elastic bands of paths by path id, used to warm start the next optimization of the same path. Only
+         * bands of previous paths are kept
+         **/
+        std::map<uint32_t, eband_optimizer::Band> warm_bands;
+        std::mutex warm_bands_mtx;
 
         //******************* Methods *******************/
 
@@ -400,11 +759,18 @@ namespace voronoi_path
         uint32_t getUniqueID();
 
         /**
-         * Find centroid of obstacles using opencv findContour(), uses data from 'map' variable
+         * Find a representative point of every obstacle, from 8-connected components of cells above collision_threshold
          * @return vector of complex numbers representing coordinates of centroids, for use in homotopy class checking
          **/
         std::vector<std::complex<double>> findObstacleCentroids();
 
+        /**
+         * Merge obstacles that are close together or small, and keep only the top max_homotopy_obstacles clusters. Sets
+         * obstacle_clusters and centers
+         * @param components obstacles found by obstacle_labeler
+         **/
+        void clusterObstacles(const std::vector<ObstacleLabeler::Component> &components);
+
         /**
          * Method for threading the process of filling up occupancy vector by iterating through the map
          * @param start_index pixel to start looping from
@@ -421,6 +787,13 @@ namespace voronoi_path
          **/
         uint32_t hash(const double &x, const double &y);
 
+        /**
+         * 64 bit rolling hash of a sequence of nodes, used to detect duplicate paths
+         * @param path sequence of node numbers
+         * @return hash of path
+         **/
+        uint64_t hashPath(const std::vector<int> &path);
+
         /**
          * Find nearest starting and ending node, given starting and ending coordinates
          * @param start starting coordinates in pixels
@@ -431,6 +804,53 @@ namespace voronoi_path
          **/
         bool getNearestNode(const GraphNode &start, const GraphNode &end, int &start_node, int &end_node);
 
+        /**
+         * Find nearest starting node and nearest node of every goal in a single pass through all nodes
+         * @param start starting coordinates in pixels
+         * @param goals goal coordinates in pixels
+         * @param start_node node number corresponding to nearest node in adj_list
+         * @param goal_nodes node numbers corresponding to nearest nodes of goals, -1 if goal has no collision free nearest node
+         * @return boolean indicating whether starting node was found
+         **/
+        bool getNearestNodes(const GraphNode &start, const std::vector<GraphNode> &goals, int &start_node, std::vector<int> &goal_nodes);
+
+        /**
+         * Grow a shortest path tree from start node using Dijkstra's algorithm until all targets are settled
+         * @param start_node node number of root of tree
+         * @param targets node numbers of targets, -1 entries are ignored
+         * @param prev previous node of every node in tree, -1 for nodes that were not reached and for start_node
+         * @return boolean indicating whether all targets were reached
+         **/
+        bool shortestPathTree(const int &start_node, const std::vector<int> &targets, std::vector<int> &prev);
+
+        /**
+         * Find alternative paths using the method set in alternative_path_method
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param shortestPath shortest path between start and end nodes
+         * @param all_paths shortest path followed by all alternative paths found
+         * @param num_paths number of alternative paths to find
+         * @param workspace optional scratch space reused by all searches, a new one is created if nullptr
+         * @return boolean indicating whether all alternative paths were found
+         **/
+        bool findAlternativePaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace = nullptr);
+
+        /**
+         * Convert paths of node numbers to paths in pixels, with start and end positions added, then interpolate and contract them
+         * @param all_paths paths of node numbers
+         * @param start start position to add to front of every path
+         * @param end end position to add to back of every path
+         * @param max_threads maximum number of threads optimizing elastic bands, 0 for one per hardware thread
+         * @return converted paths, each given a new unique id
+         **/
+        std::vector<Path> nodePathsToPaths(const std::vector<std::vector<int>> &all_paths, const GraphNode &start, const GraphNode &end, int max_threads = 0);
+
+        /**
+         * Swap the shortest path by euclidean length to the front, contraction can change which path is shortest
+         * @param paths paths to reorder
+         **/
+        void moveShortestPathFirst(std::vector<Path> &paths);
+
         /**
          * Find kth shortest paths using Yen's algorithm
          * @param start_node node number of starting node
@@ -438,19 +858,117 @@ namespace voronoi_path
          * @param shortestPath shortest path that was previously found using findShortestPath()
          * @param all_paths all kth shortest paths
          * @param num_paths number of paths to find. If num_paths = 1, total paths including shortest path will be 2
+         * @param workspace optional scratch space reused by all searches, a new one is created if nullptr
+         * @return boolean indicating success
+         **/
+        bool kthShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace = nullptr);
+
+        /**
+         * Find kth shortest paths using Yen's algorithm, continuing from a previous state
+         * @param state state to continue from, updated with the progress made. Initialize with resetYenState
+         * @param all_paths shortest path followed by up to num_paths alternative paths
+         * @param num_paths number of paths to find. If num_paths = 1, total paths including shortest path will be 2
+         * @param workspace optional scratch space reused by all searches, a new one is created if nullptr
+         * @param deadline optional time after which no more spur nodes are explored
+         * @return boolean indicating whether all paths were found
+         **/
+        bool kthShortestPaths(YenState &state, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace = nullptr, const std::chrono::steady_clock::time_point *deadline = nullptr);
+
+        /**
+         * Start a new Yen's algorithm search in state
+         * @param state state to reset
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param shortestPath shortest path between start and end nodes
+         **/
+        void resetYenState(YenState &state, const int &start_node, const int &end_node, const std::vector<int> &shortestPath);
+
+        /**
+         * Find alternative paths using the penalty method. Weights of edges used by the latest path are multiplied by penalty_factor
+         * in a weight overlay, then A* is run again on the unmodified topology. Repeats until num_paths paths in distinct homotopy
+         * classes are found or penalty_max_iterations is reached
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param shortestPath shortest path that was previously found using findShortestPath()
+         * @param all_paths shortest path followed by all alternative paths found
+         * @param num_paths number of paths to find. If num_paths = 1, total paths including shortest path will be 2
+         * @param workspace optional scratch space reused by all searches, a new one is created if nullptr
+         * @param deadline optional time after which no more searches are done
+         * @return boolean indicating success
+         **/
+        bool penaltyShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace = nullptr, const std::chrono::steady_clock::time_point *deadline = nullptr);
+
+        /**
+         * Find shortest path on adj_list. Uses the contraction hierarchy if it is built and no weight overlay is given,
+         * otherwise uses A* algorithm
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param path shortest path that was found
+         * @param weight_overlay optional multipliers for edge lengths, same layout as adj_list. ie weight_overlay[i][j] is used for
+         * the edge from node i to adj_list[i][j]. Multipliers must be >= 1 for the heuristic to remain admissible
+         * @param workspace optional scratch space for the search, a new one is created if nullptr
+         * @return boolean indicating success
+         **/
+        bool findShortestPath(const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay = nullptr, SearchWorkspace *workspace = nullptr);
+
+        /**
+         * Find shortest path using the incremental search engine. The search tree is reused if the goal node has not changed
+         * since the previous call, otherwise a new search is started
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param path shortest path that was found
+         * @return boolean indicating success
+         **/
+        bool findIncrementalPath(const int &start_node, const int &end_node, std::vector<int> &path);
+
+        /**
+         * Find shortest path using A* algorithm and the heuristic from heuristic()
+         * @param adj adjacency list to search, same layout as adj_list. Entries of -1 are deleted edges
+         * @param start_node node number of starting node
+         * @param end_node node number of ending node
+         * @param path shortest path that was found
+         * @param weight_overlay optional multipliers for edge lengths, same layout as adj
+         * @param workspace optional scratch space for the search, a new one is created if nullptr. The workspace's mode selects
+         * the search direction
          * @return boolean indicating success
          **/
-        bool kthShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths);
+        bool findShortestPath(const std::vector<std::vector<int>> &adj, const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay = nullptr, SearchWorkspace *workspace = nullptr);
 
         /**
-         * Find shortest path using A* algorithm and Euclidean distance heuristic
+         * Find shortest path using bidirectional A* with average potentials, so that the potentials of both searches are
+         * consistent and the first meeting that satisfies the stopping condition gives the shortest path
+         * @param adj adjacency list to search, entries of -1 are deleted edges. Edges must be undirected
          * @param start_node node number of starting node
          * @param end_node node number of ending node
          * @param path shortest path that was found
-         * @param cost cost of the shortest path, sum of all edge lengths in the path, units are pixels
+         * @param weight_overlay optional multipliers for edge lengths, same layout as adj. Multipliers of both directions
+         * of an edge must be equal
+         * @param ws scratch space for the search, must be prepared
          * @return boolean indicating success
          **/
-        bool findShortestPath(const int &start_node, const int &end_node, std::vector<int> &path);
+        bool bidirectionalSearch(const std::vector<std::vector<int>> &adj, const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay, SearchWorkspace &ws);
+
+        /**
+         * Select num_landmarks landmarks in the largest connected component using farthest point selection and store the
+         * graph distances from each of them in landmark_dists. Expects adj_list and node_inf to be up to date
+         **/
+        void computeLandmarks();
+
+        /**
+         * Single source Dijkstra on adj_list using Euclidean edge lengths
+         * @param source node number of source node
+         * @param dist output distances from source to every node, infinity if unreachable
+         **/
+        void graphDistances(const int &source, std::vector<double> &dist);
+
+        /**
+         * Lower bound of the graph distance between 2 nodes. Max of the Euclidean distance and the landmark triangle
+         * inequality bounds |d(l, target) - d(l, node)|. Remains admissible when edges are removed or weights are scaled up
+         * @param node node number of node to estimate from
+         * @param target node number of node to estimate to
+         * @return lower bound of distance in pixels
+         **/
+        double heuristic(const int &node, const int &target);
 
         /**
          * Removes voronoi vertices that are in obstacles
@@ -508,6 +1026,68 @@ namespace voronoi_path
          **/
         std::complex<double> calcHomotopyClass(const std::vector<GraphNode> &path_);
 
+        /**
+         * Calculate the homotopy class of a node based path by summing the cached contributions of its graph edges. Only the
+         * optional connector segments from start and to end, and edges that are not in adj_list, are calculated on the fly
+         * @param path_ node numbers of path
+         * @param start optional position connected to the first node of the path
+         * @param end optional position connected to the last node of the path
+         * @return complex value representing the homotopy class of path_, same as calcHomotopyClass of the pixel path
+         **/
+        std::complex<double> calcHomotopyClass(const std::vector<int> &path_, const GraphNode *start = nullptr, const GraphNode *end = nullptr);
+
+        /**
+         * Calculate the homotopy class of a path using the invariant set in homotopy_invariant
+         * @param path_ path to calculate homotopy class
+         * @return homotopy class of path_
+         **/
+        HomotopyClass getHomotopyClass(const std::vector<GraphNode> &path_);
+
+        /**
+         * Calculate the homotopy class of a node based path using the invariant set in homotopy_invariant, from the cached
+         * contributions of its graph edges
+         * @param path_ node numbers of path
+         * @param start optional position connected to the first node of the path
+         * @param end optional position connected to the last node of the path
+         * @return homotopy class of path_
+         **/
+        HomotopyClass getHomotopyClass(const std::vector<int> &path_, const GraphNode *start = nullptr, const GraphNode *end = nullptr);
+
+        /**
+         * Get the homotopy class of a path using the class cached in it. The cache is returned directly if the path and
+         * obstacles did not change since it was computed. If only part of the path changed, such as the start being trimmed
+         * during replanning, the H-signature is updated using only the segments that changed. The cache is updated
+         * @param path path to get homotopy class of
+         * @return homotopy class of path
+         **/
+        const HomotopyClass &getPathHomotopyClass(Path &path);
+
+        /**
+         * Append the class of a path that continues from the end of another path
+         * @param h_class class of the first path, the class of both paths joined is stored here
+         * @param next class of the path to append
+         **/
+        void appendHomotopyClass(HomotopyClass &h_class, const HomotopyClass &next);
+
+        /**
+         * Set obstacles of homotopy_kernel from centers and obs_coeff, and increase homotopy_version if they changed
+         **/
+        void updateHomotopyObstacles();
+
+        /**
+         * Calculate the contribution of a single straight edge to the homotopy class, summed over all obstacles
+         * @param from first point of edge
+         * @param to second point of edge
+         * @return complex contribution of edge
+         **/
+        std::complex<double> edgeHomotopyValue(const std::complex<double> &from, const std::complex<double> &to);
+
+        /**
+         * Precompute the homotopy class contribution of every edge in adj_list into edge_h_signature, or into
+         * edge_crossing_word if homotopy_invariant is CROSSING_WORD, in parallel
+         **/
+        void computeEdgeHSignatures();
+
         /**
          * Convert node based path to pixel based path
          * @param path_ path to be converted, will not be modified
@@ -516,14 +1096,31 @@ namespace voronoi_path
         std::vector<GraphNode> convertToPixelPath(const std::vector<int> &path_);
 
         /**
-         * Trim the beginning of path such that the starting node is directly connected to the node before X,
-         * where X is the node that will cause a collision if the starting node is directly connected to
-         * @param path path to trim
-         * @param allow_inflation function stops immediately if a node is in inflation if param is true, otherwise trimming continues
+         * Pull path taut inside the corridor formed by the clearance around each of its points, using the funnel
+         * algorithm. Loops that return into the free disc of an earlier point are cut, then every point contributes a
+         * portal perpendicular to the path that spans its free space, and the shortest path through all portals is found
+         * in linear time. Each straight segment of the result is confirmed with one collision check. Without a distance
+         * field for the current map the path is not contracted
+         * @param path path to contract, densely interpolated
+         * @param allow_inflation points in inflation are kept if param is true, otherwise they are erased before contraction
          * @return bool indicating success
          **/
         bool contractPath(std::vector<GraphNode> &path, bool allow_inflation = false);
 
+        /**
+         * Funnel algorithm through the portals of corridor points between start_index and end_index, used by contractPath
+         * @param corridor points of the path
+         * @param clearance free radius around each corridor point
+         * @param start starting point, lies on the portal of start_index
+         * @param start_index index of the corridor point of the first portal
+         * @param end ending point, lies on the portal of end_index
+         * @param end_index index of the corridor point of the last portal
+         * @param scale portals span clearance multiplied by scale on each side of their point
+         * @param corners waypoints after start are appended to this, ending with end
+         **/
+        void pullTaut(const std::vector<GraphNode> &corridor, const std::vector<double> &clearance, const GraphNode &start, const int &start_index,
+                      const GraphNode &end, const int &end_index, const double &scale, std::vector<GraphNode> &corners);
+
         /**
          * Find if any of the vertices are in concave area of costmap, causing the path to become stuck
          * Remove the middle vertex if found
@@ -536,9 +1133,17 @@ namespace voronoi_path
          * Interpolate paths before contraction to allow smoother result, uses the method above to achieve contraction
          * @param paths paths to contract
          * @param allow_inflation function stops immediately if a node is in inflation if param is true, otherwise trimming continues
+         * @param any_warm_band if a path does not follow the elastic band stored under its id, try the bands of all other paths
+         * @param max_threads maximum number of threads optimizing elastic bands, including the threads moving bubbles with jacobi_update_. 0 for one per hardware thread
+         * @param find_stuck_vertex look for vertices where the path is stuck, not done for paths received from backtrackPlan
          * @return bool indicating success
          **/
-        bool interpolateContractPaths(std::vector<Path> &paths, bool allow_inflation = false);
+        bool interpolateContractPaths(std::vector<Path> &paths, bool allow_inflation = false, bool any_warm_band = false, int max_threads = 0, bool find_stuck_vertex = true);
+
+        /**
+         * Remove the warm start elastic bands of all paths that are not previous paths
+         **/
+        void pruneWarmBands();
 
         /**
          * Checks if the two complex homotopy classes are outside the threshold, ie unique/different
@@ -548,6 +1153,14 @@ namespace voronoi_path
          **/
         bool isClassDifferent(const std::complex<double> &complex_1, const std::complex<double> &complex_2);
 
+        /**
+         * Checks if two homotopy classes are different using the invariant set in homotopy_invariant
+         * @param class_1 class 1 to check
+         * @param class_2 class 2 to check
+         * @return bool indicating true if the 2 classes are unique
+         **/
+        bool isClassDifferent(const HomotopyClass &class_1, const HomotopyClass &class_2);
+
         /**
          * Traverses recursively a branch from dead end side towards branch side, if branch is found, then entire series of edges are removed
          * If branch is not found before lonely_branch_dist_threshold, then branch is not removed
@@ -565,15 +1178,6 @@ namespace voronoi_path
          **/
         bool edgesToAdjacency(const std::vector<const jcv_edge*>& edge_vector);
 
-        /**
-         * Check if a point lies in a square formed by points on 2 opposite vertices
-         * @param point point to check
-         * @param line_point_a first point of the line
-         * @param line_point_b second point of the line, order of points do not matter
-         * @return boolean indicating whether the point lies on the line
-         **/
-        bool liesInSquare(const GraphNode &point, const GraphNode &line_point_a, const GraphNode &line_point_b);
-
         /**
          * Check if there is a cycle within certain depth from a given starting node
          * @param start starting node index
@@ -0,0 +1,325 @@
+#include <voronoi_planner_lib/contraction_hierarchy.h>
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <cmath>
+
+namespace voronoi_path
+{
+    void ContractionHierarchy::build(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf)
+    {
+        int num_nodes = adj_list.size();
+        up_edges.assign(num_nodes, std::vector<Edge>());
+        rank.assign(num_nodes, -1);
+
+        //Working graph of uncontracted nodes, keeps the lowest weight edge and its middle node for every neighbor
+        std::vector<std::vector<Edge>> graph(num_nodes);
+        auto addEdge = [&graph](const int &from, const int &to, const double &weight, const int &middle) {
+            for (auto &edge : graph[from])
+            {
+                if (edge.to == to)
+                {
+                    if (weight < edge.weight)
+                    {
+                        edge.weight = weight;
+                        edge.middle = middle;
+                    }
+
+                    return;
+                }
+            }
+
+            graph[from].push_back({to, weight, middle});
+        };
+
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            for (const auto &j : adj_list[i])
+            {
+                if (j == -1 || j == i)
+                    continue;
+
+                double weight = std::sqrt(pow(node_inf[i].x - node_inf[j].x, 2) + pow(node_inf[i].y - node_inf[j].y, 2));
+                addEdge(i, j, weight, -1);
+                addEdge(j, i, weight, -1);
+            }
+        }
+
+        //Scratch space for witness searches, only touched entries are reset after each search
+        std::vector<double> witness_dist(num_nodes, std::numeric_limits<double>::infinity());
+        std::vector<int> touched;
+        std::vector<int> contracted_neighbors(num_nodes, 0);
+        typedef std::pair<double, int> QueueItem;
+
+        //Bounded Dijkstra from source that avoids excluded and contracted nodes, results are stored in witness_dist
+        auto witnessDistances = [&](const int &source, const int &excluded, const double &max_dist) {
+            for (const auto &node : touched)
+                witness_dist[node] = std::numeric_limits<double>::infinity();
+            touched.clear();
+
+            std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue;
+            witness_dist[source] = 0;
+            touched.push_back(source);
+            queue.emplace(0, source);
+
+            int settled = 0;
+            while (!queue.empty() && settled < witness_settle_limit)
+            {
+                QueueItem curr = queue.top();
+                queue.pop();
+
+                if (curr.first > witness_dist[curr.second])
+                    continue;
+
+                if (curr.first > max_dist)
+                    break;
+
+                ++settled;
+                for (const auto &edge : graph[curr.second])
+                {
+                    if (edge.to == excluded || rank[edge.to] != -1)
+                        continue;
+
+                    double next_dist = curr.first + edge.weight;
+                    if (next_dist < witness_dist[edge.to])
+                    {
+                        if (witness_dist[edge.to] == std::numeric_limits<double>::infinity())
+                            touched.push_back(edge.to);
+
+                        witness_dist[edge.to] = next_dist;
+                        queue.emplace(next_dist, edge.to);
+                    }
+                }
+            }
+        };
+
+        //Find shortcuts required to contract node, shortcut i goes from shortcut_from[i] to shortcuts[i].to
+        std::vector<Edge> shortcuts;
+        std::vector<int> shortcut_from;
+        auto findShortcuts = [&](const int &node) {
+            shortcuts.clear();
+            shortcut_from.clear();
+
+            const std::vector<Edge> &neighbors = graph[node];
+            for (int a = 0; a < static_cast<int>(neighbors.size()); ++a)
+            {
+                if (rank[neighbors[a].to] != -1)
+                    continue;
+
+                //Max distance of all shortcut candidates from this neighbor, bounds the witness search
+                double max_dist = 0;
+                for (int b = a + 1; b < static_cast<int>(neighbors.size()); ++b)
+                {
+                    if (rank[neighbors[b].to] == -1)
+                        max_dist = std::max(max_dist, neighbors[a].weight + neighbors[b].weight);
+                }
+
+                if (max_dist == 0)
+                    continue;
+
+                witnessDistances(neighbors[a].to, node, max_dist);
+
+                for (int b = a + 1; b < static_cast<int>(neighbors.size()); ++b)
+                {
+                    if (rank[neighbors[b].to] != -1)
+                        continue;
+
+                    double via_dist = neighbors[a].weight + neighbors[b].weight;
+                    if (witness_dist[neighbors[b].to] > via_dist)
+                    {
+                        shortcut_from.push_back(neighbors[a].to);
+                        shortcuts.push_back({neighbors[b].to, via_dist, node});
+                    }
+                }
+            }
+        };
+
+        auto priority = [&](const int &node) {
+            int degree = 0;
+            for (const auto &edge : graph[node])
+            {
+                if (rank[edge.to] == -1)
+                    degree++;
+            }
+
+            findShortcuts(node);
+            return static_cast<int>(shortcuts.size()) - degree + contracted_neighbors[node];
+        };
+
+        //Lazy updated queue of nodes ordered by priority
+        std::priority_queue<std::pair<int, int>, std::vector<std::pair<int, int>>, std::greater<std::pair<int, int>>> order;
+        for (int i = 0; i < num_nodes; ++i)
+            order.emplace(priority(i), i);
+
+        int curr_rank = 0;
+        while (!order.empty())
+        {
+            int node = order.top().second;
+            order.pop();
+
+            if (rank[node] != -1)
+                continue;
+
+            //Recompute priority, contract only if node is still the lowest priority
+            int new_priority = priority(node);
+            if (!order.empty() && new_priority > order.top().first)
+            {
+                order.emplace(new_priority, node);
+                continue;
+            }
+
+            //Shortcuts from last priority computation are for this node
+            for (int i = 0; i < static_cast<int>(shortcuts.size()); ++i)
+            {
+                addEdge(shortcut_from[i], shortcuts[i].to, shortcuts[i].weight, shortcuts[i].middle);
+                addEdge(shortcuts[i].to, shortcut_from[i], shortcuts[i].weight, shortcuts[i].middle);
+            }
+
+            //All remaining neighbors have higher rank, store the edges to them in upward graph
+            for (const auto &edge : graph[node])
+            {
+                if (rank[edge.to] == -1)
+                {
+                    up_edges[node].push_back(edge);
+                    contracted_neighbors[edge.to]++;
+                }
+            }
+
+            rank[node] = curr_rank++;
+        }
+    }
+
+    bool ContractionHierarchy::query(const int &start_node, const int &end_node, std::vector<int> &path) const
+    {
+        int num_nodes = up_edges.size();
+        if (start_node < 0 || end_node < 0 || start_node >= num_nodes || end_node >= num_nodes)
+            return false;
+
+        if (start_node == end_node)
+        {
+            path.push_back(start_node);
+            return true;
+        }
+
+        typedef std::pair<double, int> QueueItem;
+
+        //Index 0 is forward search from start, index 1 is backward search from end
+        std::vector<double> dist[2] = {std::vector<double>(num_nodes, std::numeric_limits<double>::infinity()),
+                                       std::vector<double>(num_nodes, std::numeric_limits<double>::infinity())};
+        std::vector<int> prev[2] = {std::vector<int>(num_nodes, -1), std::vector<int>(num_nodes, -1)};
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> queue[2];
+
+        dist[0][start_node] = 0;
+        dist[1][end_node] = 0;
+        queue[0].emplace(0, start_node);
+        queue[1].emplace(0, end_node);
+
+        double best = std::numeric_limits<double>::infinity();
+        int meeting_node = -1;
+
+        //Alternate between both searches, each search stops once its smallest key exceeds the best distance found
+        int dir = 0;
+        while (!queue[0].empty() || !queue[1].empty())
+        {
+            if (queue[dir].empty() || queue[dir].top().first >= best)
+            {
+                while (!queue[dir].empty())
+                    queue[dir].pop();
+
+                dir = 1 - dir;
+                continue;
+            }
+
+            QueueItem curr = queue[dir].top();
+            queue[dir].pop();
+
+            if (curr.first > dist[dir][curr.second])
+                continue;
+
+            //Update best meeting node
+            double total = curr.first + dist[1 - dir][curr.second];
+            if (total < best)
+            {
+                best = total;
+                meeting_node = curr.second;
+            }
+
+            for (const auto &edge : up_edges[curr.second])
+            {
+                double next_dist = curr.first + edge.weight;
+                if (next_dist < dist[dir][edge.to])
+                {
+                    dist[dir][edge.to] = next_dist;
+                    prev[dir][edge.to] = curr.second;
+                    queue[dir].emplace(next_dist, edge.to);
+
+                    if (next_dist + dist[1 - dir][edge.to] < best)
+                    {
+                        best = next_dist + dist[1 - dir][edge.to];
+                        meeting_node = edge.to;
+                    }
+                }
+            }
+
+            dir = 1 - dir;
+        }
+
+        if (meeting_node == -1)
+            return false;
+
+        //Chain of hierarchy nodes from start to end through the meeting node
+        std::vector<int> chain;
+        for (int node = meeting_node; node != -1; node = prev[0][node])
+            chain.push_back(node);
+        std::reverse(chain.begin(), chain.end());
+
+        for (int node = prev[1][meeting_node]; node != -1; node = prev[1][node])
+            chain.push_back(node);
+
+        //Unpack every edge of the chain into original nodes
+        path.push_back(chain[0]);
+        for (int i = 0; i < static_cast<int>(chain.size()) - 1; ++i)
+            unpackEdge(chain[i], chain[i + 1], getMiddle(chain[i], chain[i + 1]), path);
+
+        return true;
+    }
+
+    void ContractionHierarchy::unpackEdge(const int &from, const int &to, const int &middle, std::vector<int> &path) const
+    {
+        if (middle == -1)
+        {
+            path.push_back(to);
+            return;
+        }
+
+        unpackEdge(from, middle, getMiddle(from, middle), path);
+        unpackEdge(middle, to, getMiddle(middle, to), path);
+    }
+
+    int ContractionHierarchy::getMiddle(const int &a, const int &b) const
+    {
+        //Edge is stored in the upward graph of the lower ranked node
+        const int &lower = rank[a] < rank[b] ? a : b;
+        const int &higher = rank[a] < rank[b] ? b : a;
+
+        for (const auto &edge : up_edges[lower])
+        {
+            if (edge.to == higher)
+                return edge.middle;
+        }
+
+        return -1;
+    }
+
+    void ContractionHierarchy::clear()
+    {
+        up_edges.clear();
+        rank.clear();
+    }
+
+    bool ContractionHierarchy::isBuilt() const
+    {
+        return !up_edges.empty();
+    }
+} // namespace voronoi_path
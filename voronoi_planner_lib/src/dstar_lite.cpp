@@ -0,0 +1,300 @@
+#include <voronoi_planner_lib/dstar_lite.h>
+#include <unordered_map>
+#include <algorithm>
+#include <limits>
+#include <cmath>
+
+namespace voronoi_path
+{
+    void DStarLite::reset(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf, const int &start_node, const int &goal_node)
+    {
+        adj = adj_list;
+        nodes = node_inf;
+
+        int num_nodes = adj.size();
+        g.assign(num_nodes, std::numeric_limits<double>::infinity());
+        rhs.assign(num_nodes, std::numeric_limits<double>::infinity());
+        open_key.assign(num_nodes, Key(0, 0));
+        in_open.assign(num_nodes, false);
+        open_list.clear();
+
+        start = start_node;
+        last_start = start_node;
+        goal = goal_node;
+        km = 0;
+
+        //Search is rooted at the goal
+        rhs[goal] = 0;
+        insertOpen(goal);
+        initialized = true;
+    }
+
+    void DStarLite::updateGraph(const std::vector<std::vector<int>> &adj_list, const std::vector<GraphNode> &node_inf)
+    {
+        if (!initialized)
+            return;
+
+        //Map old node numbers to new node numbers by pixel coordinates
+        std::unordered_map<uint32_t, int> new_index;
+        new_index.reserve(node_inf.size());
+        for (int i = 0; i < static_cast<int>(node_inf.size()); ++i)
+            new_index[nodeKey(node_inf[i])] = i;
+
+        std::vector<int> old_to_new(nodes.size(), -1);
+        std::vector<int> new_to_old(node_inf.size(), -1);
+        for (int i = 0; i < static_cast<int>(nodes.size()); ++i)
+        {
+            auto it = new_index.find(nodeKey(nodes[i]));
+            if (it != new_index.end())
+            {
+                old_to_new[i] = it->second;
+                new_to_old[it->second] = i;
+            }
+        }
+
+        //Goal no longer exists, search tree cannot be reused
+        if (old_to_new[goal] == -1)
+        {
+            initialized = false;
+            return;
+        }
+
+        //Carry over search tree values of matching nodes
+        int num_nodes = adj_list.size();
+        std::vector<double> new_g(num_nodes, std::numeric_limits<double>::infinity());
+        std::vector<double> new_rhs(num_nodes, std::numeric_limits<double>::infinity());
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (new_to_old[i] != -1)
+            {
+                new_g[i] = g[new_to_old[i]];
+                new_rhs[i] = rhs[new_to_old[i]];
+            }
+        }
+
+        //Nodes are changed if they are new, moved within their pixel, or their set of neighbors is different
+        std::vector<bool> changed(num_nodes, false);
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            int old = new_to_old[i];
+            if (old == -1 || nodes[old].x != node_inf[i].x || nodes[old].y != node_inf[i].y)
+            {
+                changed[i] = true;
+                continue;
+            }
+
+            std::vector<int> old_neighbors, new_neighbors;
+            for (const auto &neighbor : adj[old])
+            {
+                if (neighbor != -1)
+                    old_neighbors.push_back(old_to_new[neighbor]);
+            }
+
+            for (const auto &neighbor : adj_list[i])
+            {
+                if (neighbor != -1)
+                    new_neighbors.push_back(neighbor);
+            }
+
+            std::sort(old_neighbors.begin(), old_neighbors.end());
+            std::sort(new_neighbors.begin(), new_neighbors.end());
+            if (old_neighbors != new_neighbors)
+                changed[i] = true;
+        }
+
+        //Moved nodes change the cost of all their edges, neighbors need to be updated as well
+        std::vector<bool> to_update(changed);
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (changed[i])
+            {
+                for (const auto &neighbor : adj_list[i])
+                {
+                    if (neighbor != -1)
+                        to_update[neighbor] = true;
+                }
+            }
+        }
+
+        adj = adj_list;
+        nodes = node_inf;
+        g = std::move(new_g);
+        rhs = std::move(new_rhs);
+        goal = old_to_new[goal];
+        start = (start >= 0 && start < static_cast<int>(old_to_new.size()) && old_to_new[start] != -1) ? old_to_new[start] : goal;
+        last_start = start;
+
+        //Keys are recomputed for the new graph, key modifier can start from 0 again
+        km = 0;
+        open_key.assign(num_nodes, Key(0, 0));
+        in_open.assign(num_nodes, false);
+        open_list.clear();
+
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (to_update[i])
+                updateVertex(i);
+
+            else if (g[i] != rhs[i])
+                insertOpen(i);
+        }
+    }
+
+    void DStarLite::updateStart(const int &start_node)
+    {
+        if (start_node == start)
+            return;
+
+        start = start_node;
+        km += heuristic(last_start, start);
+        last_start = start;
+    }
+
+    bool DStarLite::computeShortestPath(std::vector<int> &path)
+    {
+        expansions = 0;
+        if (!initialized || start < 0 || start >= static_cast<int>(adj.size()))
+            return false;
+
+        while (!open_list.empty() && (open_list.begin()->first < calculateKey(start) || rhs[start] != g[start]))
+        {
+            Key k_old = open_list.begin()->first;
+            int u = open_list.begin()->second;
+            Key k_new = calculateKey(u);
+            ++expansions;
+
+            if (k_old < k_new)
+            {
+                removeOpen(u);
+                open_key[u] = k_new;
+                in_open[u] = true;
+                open_list.emplace(k_new, u);
+            }
+
+            else if (g[u] > rhs[u])
+            {
+                g[u] = rhs[u];
+                removeOpen(u);
+                for (const auto &pred : adj[u])
+                {
+                    if (pred != -1)
+                        updateVertex(pred);
+                }
+            }
+
+            else
+            {
+                g[u] = std::numeric_limits<double>::infinity();
+                updateVertex(u);
+                for (const auto &pred : adj[u])
+                {
+                    if (pred != -1)
+                        updateVertex(pred);
+                }
+            }
+        }
+
+        if (g[start] == std::numeric_limits<double>::infinity())
+            return false;
+
+        //Follow the lowest cost successors from start to goal
+        std::vector<int> temp_path(1, start);
+        int curr = start;
+        while (curr != goal)
+        {
+            int best = -1;
+            double best_cost = std::numeric_limits<double>::infinity();
+            for (const auto &succ : adj[curr])
+            {
+                if (succ == -1)
+                    continue;
+
+                double succ_cost = cost(curr, succ) + g[succ];
+                if (succ_cost < best_cost)
+                {
+                    best_cost = succ_cost;
+                    best = succ;
+                }
+            }
+
+            //Search tree is broken, should not happen if g[start] is finite
+            if (best == -1 || temp_path.size() > adj.size())
+                return false;
+
+            temp_path.push_back(best);
+            curr = best;
+        }
+
+        path.insert(path.end(), temp_path.begin(), temp_path.end());
+        return true;
+    }
+
+    bool DStarLite::isInitialized() const
+    {
+        return initialized;
+    }
+
+    int DStarLite::getGoal() const
+    {
+        return initialized ? goal : -1;
+    }
+
+    int DStarLite::getExpansions() const
+    {
+        return expansions;
+    }
+
+    double DStarLite::cost(const int &a, const int &b) const
+    {
+        return std::sqrt(pow(nodes[a].x - nodes[b].x, 2) + pow(nodes[a].y - nodes[b].y, 2));
+    }
+
+    double DStarLite::heuristic(const int &a, const int &b) const
+    {
+        return cost(a, b);
+    }
+
+    DStarLite::Key DStarLite::calculateKey(const int &node) const
+    {
+        double min_g = std::min(g[node], rhs[node]);
+        return Key(min_g + heuristic(start, node) + km, min_g);
+    }
+
+    void DStarLite::updateVertex(const int &node)
+    {
+        if (node != goal)
+        {
+            rhs[node] = std::numeric_limits<double>::infinity();
+            for (const auto &succ : adj[node])
+            {
+                if (succ != -1)
+                    rhs[node] = std::min(rhs[node], cost(node, succ) + g[succ]);
+            }
+        }
+
+        removeOpen(node);
+        if (g[node] != rhs[node])
+            insertOpen(node);
+    }
+
+    void DStarLite::insertOpen(const int &node)
+    {
+        open_key[node] = calculateKey(node);
+        in_open[node] = true;
+        open_list.emplace(open_key[node], node);
+    }
+
+    void DStarLite::removeOpen(const int &node)
+    {
+        if (in_open[node])
+        {
+            open_list.erase(std::make_pair(open_key[node], node));
+            in_open[node] = false;
+        }
+    }
+
+    uint32_t DStarLite::nodeKey(const GraphNode &node)
+    {
+        return static_cast<uint32_t>((static_cast<uint16_t>(node.x) << 16) ^ static_cast<uint16_t>(node.y));
+    }
+} // namespace voronoi_path
@@ -0,0 +1,243 @@
+#include <voronoi_planner_lib/homotopy_kernel.h>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <algorithm>
+#include <numeric>
+
+namespace voronoi_path
+{
+    namespace
+    {
+        /**
+         * Natural log of a positive normal double, absolute error below 1e-10. The exponent is taken from the bits directly
+         * and the log of the mantissa is found with the atanh series
+         **/
+        inline double fastLog(const double &x)
+        {
+            uint64_t bits;
+            std::memcpy(&bits, &x, sizeof(bits));
+
+            //Exponent field as a double, by placing it in the mantissa of 2^52, avoids integer to double conversion
+            uint64_t exponent_bits = (bits >> 52) | 0x4330000000000000ULL;
+            double exponent;
+            std::memcpy(&exponent, &exponent_bits, sizeof(exponent));
+            exponent -= 4503599627370496.0 + 1023.0;
+
+            uint64_t mantissa_bits = (bits & 0x000FFFFFFFFFFFFFULL) | 0x3FF0000000000000ULL;
+            double mantissa;
+            std::memcpy(&mantissa, &mantissa_bits, sizeof(mantissa));
+
+            //Move mantissa to [sqrt(0.5), sqrt(2)) so that the series converges quickly
+            bool high = mantissa > M_SQRT2;
+            mantissa = high ? mantissa * 0.5 : mantissa;
+            exponent = high ? exponent + 1.0 : exponent;
+
+            //log(m) = 2 * atanh((m - 1) / (m + 1))
+            double s = (mantissa - 1.0) / (mantissa + 1.0);
+            double s2 = s * s;
+            double series = 1.0 + s2 * (1.0 / 3 + s2 * (1.0 / 5 + s2 * (1.0 / 7 + s2 * (1.0 / 9 + s2 * (1.0 / 11)))));
+
+            return exponent * M_LN2 + 2.0 * s * series;
+        }
+
+        /**
+         * atan2 with absolute error below 1e-8. Argument is reduced to [0, tan(pi/8)] using octant symmetry and
+         * atan(a) = pi/4 + atan((a - 1) / (a + 1)), then the Taylor series is used. Returns 0 for atan2(0, 0)
+         **/
+        inline double fastAtan2(const double &y, const double &x)
+        {
+            double abs_x = std::fabs(x);
+            double abs_y = std::fabs(y);
+            double max_xy = abs_x > abs_y ? abs_x : abs_y;
+            double min_xy = abs_x > abs_y ? abs_y : abs_x;
+            double a = min_xy / (max_xy > 0 ? max_xy : 1.0);
+
+            bool reduce = a > 0.41421356237309503;
+            double t = reduce ? (a - 1.0) / (a + 1.0) : a;
+            double offset = reduce ? M_PI_4 : 0.0;
+
+            double t2 = t * t;
+            double series = 1.0 - t2 * (1.0 / 3 - t2 * (1.0 / 5 - t2 * (1.0 / 7 - t2 * (1.0 / 9 - t2 * (1.0 / 11 - t2 * (1.0 / 13 - t2 * (1.0 / 15 - t2 * (1.0 / 17))))))));
+            double angle = offset + t * series;
+
+            //Undo octant reduction
+            angle = abs_y > abs_x ? M_PI_2 - angle : angle;
+            angle = x < 0 ? M_PI - angle : angle;
+            return y < 0 ? -angle : angle;
+        }
+    } // namespace
+
+    bool HomotopyKernel::setObstacles(const std::vector<std::complex<double>> &centers, const std::vector<std::complex<double>> &coeff)
+    {
+        //Compare with current obstacles before overwriting
+        bool changed = static_cast<int>(centers.size()) != num_obstacles;
+        for (int i = 0; i < num_obstacles && !changed; ++i)
+        {
+            std::complex<double> curr_coeff = i < static_cast<int>(coeff.size()) ? coeff[i] : std::complex<double>(0, 0);
+            changed = centers[i].real() != center_x[i] || centers[i].imag() != center_y[i] ||
+                      curr_coeff.real() != coeff_re[i] || curr_coeff.imag() != coeff_im[i];
+        }
+
+        if (!changed)
+            return false;
+
+        num_obstacles = centers.size();
+        int padded_size = (num_obstacles + LANES - 1) / LANES * LANES;
+
+        //Padding obstacles are far from the map so that their log and angle terms stay finite, and contribute nothing
+        center_x.assign(padded_size, 1e6);
+        center_y.assign(padded_size, 1e6);
+        coeff_re.assign(padded_size, 0);
+        coeff_im.assign(padded_size, 0);
+
+        for (int i = 0; i < num_obstacles; ++i)
+        {
+            center_x[i] = centers[i].real();
+            center_y[i] = centers[i].imag();
+
+            if (i < static_cast<int>(coeff.size()))
+            {
+                coeff_re[i] = coeff[i].real();
+                coeff_im[i] = coeff[i].imag();
+            }
+        }
+
+        //Rays sorted by x so that the rays crossed by an edge form a contiguous range
+        std::vector<int> order(num_obstacles);
+        std::iota(order.begin(), order.end(), 0);
+        std::vector<int64_t> fixed_x(num_obstacles);
+        for (int i = 0; i < num_obstacles; ++i)
+            fixed_x[i] = toFixedPoint(centers[i].real());
+
+        std::stable_sort(order.begin(), order.end(), [&fixed_x](const int &a, const int &b) {
+            return fixed_x[a] < fixed_x[b];
+        });
+
+        ray_x.resize(num_obstacles);
+        ray_y.resize(num_obstacles);
+        ray_obstacle = order;
+        for (int i = 0; i < num_obstacles; ++i)
+        {
+            ray_x[i] = fixed_x[order[i]];
+            ray_y[i] = toFixedPoint(centers[order[i]].imag());
+        }
+
+        return true;
+    }
+
+    std::complex<double> HomotopyKernel::edgeValue(const std::complex<double> &from, const std::complex<double> &to) const
+    {
+        const double from_x = from.real();
+        const double from_y = from.imag();
+        const double to_x = to.real();
+        const double to_y = to.imag();
+
+        const double *cx = center_x.data();
+        const double *cy = center_y.data();
+        const double *kr = coeff_re.data();
+        const double *ki = coeff_im.data();
+        const int padded_size = center_x.size();
+
+        //Separate accumulators for each lane, summed at the end
+        double sum_re[LANES] = {0};
+        double sum_im[LANES] = {0};
+
+        for (int j = 0; j < padded_size; j += LANES)
+        {
+            for (int k = 0; k < LANES; ++k)
+            {
+                double ax = from_x - cx[j + k];
+                double ay = from_y - cy[j + k];
+                double bx = to_x - cx[j + k];
+                double by = to_y - cy[j + k];
+
+                //log|b| - log|a|, and the angle from a to b which is already the smallest angle
+                double real_part = 0.5 * fastLog((bx * bx + by * by) / (ax * ax + ay * ay));
+                double im_part = fastAtan2(ax * by - ay * bx, ax * bx + ay * by);
+
+                sum_re[k] += real_part * kr[j + k] - im_part * ki[j + k];
+                sum_im[k] += real_part * ki[j + k] + im_part * kr[j + k];
+            }
+        }
+
+        double total_re = 0;
+        double total_im = 0;
+        for (int k = 0; k < LANES; ++k)
+        {
+            total_re += sum_re[k];
+            total_im += sum_im[k];
+        }
+
+        return std::complex<double>(total_re, total_im);
+    }
+
+    void HomotopyKernel::edgeCrossings(const std::complex<double> &from, const std::complex<double> &to, std::vector<int> &letters) const
+    {
+        const int64_t from_x = toFixedPoint(from.real());
+        const int64_t from_y = toFixedPoint(from.imag());
+        const int64_t to_x = toFixedPoint(to.real());
+        const int64_t to_y = toFixedPoint(to.imag());
+
+        //Points with x equal to a ray are on its right side, so an edge crosses the line of a ray iff ray x is in (min x, max x]
+        if (from_x == to_x)
+            return;
+
+        const int64_t dx = to_x - from_x;
+        const int64_t dy = to_y - from_y;
+        auto first = std::upper_bound(ray_x.begin(), ray_x.end(), std::min(from_x, to_x)) - ray_x.begin();
+        auto last = std::upper_bound(ray_x.begin(), ray_x.end(), std::max(from_x, to_x)) - ray_x.begin();
+
+        //Rays are visited from left to right, reversed for edges going from right to left so that reversed edges give inverse letters
+        const size_t begin_size = letters.size();
+        for (auto i = first; i < last; ++i)
+        {
+            //Edge crosses the ray if the crossing with the line x = ray_x is above the obstacle center. Multiplied by dx to stay
+            //in integers, which flips the sign if the edge goes to the left
+            int64_t above = (from_y - ray_y[i]) * dx + dy * (ray_x[i] - from_x);
+            if (dx > 0 ? above > 0 : above < 0)
+                letters.push_back(dx > 0 ? ray_obstacle[i] + 1 : -(ray_obstacle[i] + 1));
+        }
+
+        if (dx < 0)
+            std::reverse(letters.begin() + begin_size, letters.end());
+    }
+
+    void HomotopyKernel::appendReduced(std::vector<int> &word, const std::vector<int> &letters)
+    {
+        for (const auto &letter : letters)
+        {
+            if (!word.empty() && word.back() == -letter)
+                word.pop_back();
+
+            else
+                word.push_back(letter);
+        }
+    }
+
+    uint64_t HomotopyKernel::wordHash(const std::vector<int> &word)
+    {
+        uint64_t hash = 14695981039346656037ULL;
+        for (const auto &letter : word)
+        {
+            uint32_t value = static_cast<uint32_t>(letter);
+            for (int byte = 0; byte < 4; ++byte)
+            {
+                hash ^= (value >> (8 * byte)) & 0xFF;
+                hash *= 1099511628211ULL;
+            }
+        }
+
+        return hash;
+    }
+
+    int64_t HomotopyKernel::toFixedPoint(const double &value)
+    {
+        return std::llround(value * FIXED_POINT_SCALE);
+    }
+
+    int HomotopyKernel::size() const
+    {
+        return num_obstacles;
+    }
+} // namespace voronoi_path
@@ -0,0 +1,332 @@
+#include <voronoi_planner_lib/obstacle_labeler.h>
+#include <algorithm>
+
+namespace voronoi_path
+{
+    void ObstacleLabeler::label(const std::vector<signed char> &data, const int &width_, const int &height_, const int &threshold_)
+    {
+        width = width_;
+        height = height_;
+        threshold = threshold_;
+        relabeled_cells = 0;
+
+        int size = width * height;
+        occupied.resize(size);
+        for (int i = 0; i < size; ++i)
+            occupied[i] = data[i] > threshold;
+
+        labels.assign(size, -1);
+        components.clear();
+        free_labels.clear();
+        all_dirty = true;
+
+        //Scan in row major order, every occupied cell that is not yet labeled starts a new component
+        for (int i = 0; i < size; ++i)
+        {
+            if (occupied[i] && labels[i] == -1)
+                floodFill(data, i);
+        }
+
+        initialized = true;
+    }
+
+    void ObstacleLabeler::update(const std::vector<signed char> &data, const int &width_, const int &height_, const int &threshold_)
+    {
+        if (!initialized || width_ != width || height_ != height || threshold_ != threshold)
+        {
+            label(data, width_, height_, threshold_);
+            return;
+        }
+
+        relabeled_cells = 0;
+
+        //Cells whose occupancy changed
+        int size = width * height;
+        std::vector<int> dirty;
+        for (int i = 0; i < size; ++i)
+        {
+            unsigned char curr = data[i] > threshold;
+            if (curr != occupied[i])
+                dirty.push_back(i);
+        }
+
+        if (dirty.empty())
+            return;
+
+        //Components that contain or neighbor a changed cell may grow, shrink, split or merge, all of them are relabeled
+        std::vector<int> seeds(dirty);
+        for (const auto &cell : dirty)
+        {
+            int x = cell % width;
+            int y = cell / width;
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny)
+            {
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+                {
+                    int label = labels[nx + ny * width];
+                    if (label != -1)
+                        clearComponent(label, seeds);
+                }
+            }
+        }
+
+        for (const auto &cell : dirty)
+            occupied[cell] = !occupied[cell];
+
+        for (const auto &cell : seeds)
+        {
+            if (occupied[cell] && labels[cell] == -1)
+                floodFill(data, cell);
+        }
+    }
+
+    void ObstacleLabeler::getComponents(std::vector<Component> &components_) const
+    {
+        components_.clear();
+        components_.reserve(components.size() - free_labels.size());
+        for (const auto &component : components)
+        {
+            if (component.representative != -1)
+                components_.push_back(component);
+        }
+    }
+
+    void ObstacleLabeler::findNearbyPairs(const int &max_gap, std::vector<std::pair<int, int>> &pairs)
+    {
+        pairs.clear();
+        if (!initialized || max_gap <= 0)
+            return;
+
+        //Fronts that meet within max_gap free cells only need to grow half of it each
+        int radius = (max_gap + 1) / 2;
+        if (max_gap != meetings_gap)
+        {
+            all_dirty = true;
+            meetings_gap = max_gap;
+        }
+
+        if (all_dirty || dirty_min_x <= dirty_max_x)
+        {
+            //Meetings can only change in cells that a relabeled component can reach. The grown window also includes
+            //every obstacle that can reach those cells, so that they are owned by the same component as in a full pass
+            int inner_min_x = 0, inner_min_y = 0, inner_max_x = width - 1, inner_max_y = height - 1;
+            if (!all_dirty)
+            {
+                inner_min_x = std::max(dirty_min_x - radius - 1, 0);
+                inner_min_y = std::max(dirty_min_y - radius - 1, 0);
+                inner_max_x = std::min(dirty_max_x + radius + 1, width - 1);
+                inner_max_y = std::min(dirty_max_y + radius + 1, height - 1);
+            }
+
+            int window_min_x = std::max(inner_min_x - radius, 0);
+            int window_min_y = std::max(inner_min_y - radius, 0);
+            int window_max_x = std::min(inner_max_x + radius, width - 1);
+            int window_max_y = std::min(inner_max_y + radius, height - 1);
+            int window_width = window_max_x - window_min_x + 1;
+            int window_height = window_max_y - window_min_y + 1;
+
+            auto inInner = [&](const int &x, const int &y) {
+                return x >= inner_min_x && x <= inner_max_x && y >= inner_min_y && y <= inner_max_y;
+            };
+
+            meetings.erase(std::remove_if(meetings.begin(), meetings.end(), [&](const Meeting &meeting) {
+                               return inInner(meeting.cell % width, meeting.cell / width);
+                           }),
+                           meetings.end());
+
+            //Owner is the component a free cell was reached from first, dist is the number of steps from that component.
+            //Both are indexed by window cell
+            owner.resize(window_width * window_height);
+            dist.assign(window_width * window_height, 0);
+            frontier.clear();
+
+            //Start from obstacle cells that border free space
+            for (int y = window_min_y; y <= window_max_y; ++y)
+            {
+                for (int x = window_min_x; x <= window_max_x; ++x)
+                {
+                    int i = x + y * width;
+                    owner[(x - window_min_x) + (y - window_min_y) * window_width] = labels[i];
+                    if (labels[i] == -1)
+                        continue;
+
+                    bool border = false;
+                    for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1) && !border; ++ny)
+                    {
+                        for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+                        {
+                            if (labels[nx + ny * width] == -1)
+                            {
+                                border = true;
+                                break;
+                            }
+                        }
+                    }
+
+                    if (border)
+                        frontier.push_back((x - window_min_x) + (y - window_min_y) * window_width);
+                }
+            }
+
+            for (int head = 0; head < static_cast<int>(frontier.size()); ++head)
+            {
+                int cell = frontier[head];
+                int x = cell % window_width;
+                int y = cell / window_width;
+                bool inner = inInner(x + window_min_x, y + window_min_y);
+                for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, window_height - 1); ++ny)
+                {
+                    for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, window_width - 1); ++nx)
+                    {
+                        int neighbor = nx + ny * window_width;
+                        if (owner[neighbor] == -1)
+                        {
+                            if (dist[cell] + 1 <= radius)
+                            {
+                                owner[neighbor] = owner[cell];
+                                dist[neighbor] = dist[cell] + 1;
+                                frontier.push_back(neighbor);
+                            }
+                        }
+
+                        else if (inner && owner[neighbor] != owner[cell] && dist[cell] + dist[neighbor] <= max_gap)
+                        {
+                            Meeting meeting;
+                            meeting.first = std::min(owner[cell], owner[neighbor]);
+                            meeting.second = std::max(owner[cell], owner[neighbor]);
+                            meeting.cell = (x + window_min_x) + (y + window_min_y) * width;
+                            meetings.push_back(meeting);
+                        }
+                    }
+                }
+            }
+
+            all_dirty = false;
+            dirty_min_x = dirty_min_y = 0;
+            dirty_max_x = dirty_max_y = -1;
+        }
+
+        pairs.reserve(meetings.size());
+        for (const auto &meeting : meetings)
+            pairs.emplace_back(meeting.first, meeting.second);
+
+        std::sort(pairs.begin(), pairs.end());
+        pairs.erase(std::unique(pairs.begin(), pairs.end()), pairs.end());
+    }
+
+    int ObstacleLabeler::getRelabeledCells() const
+    {
+        return relabeled_cells;
+    }
+
+    void ObstacleLabeler::floodFill(const std::vector<signed char> &data, const int &seed)
+    {
+        int label;
+        if (free_labels.empty())
+        {
+            label = components.size();
+            components.emplace_back();
+        }
+
+        else
+        {
+            label = free_labels.back();
+            free_labels.pop_back();
+        }
+
+        Component component;
+        component.label = label;
+        component.representative = seed;
+        component.min_x = component.max_x = seed % width;
+        component.min_y = component.max_y = seed / width;
+
+        queue.clear();
+        queue.push_back(seed);
+        labels[seed] = label;
+
+        //Queue is never popped from the front, head index walks through it instead
+        for (int head = 0; head < static_cast<int>(queue.size()); ++head)
+        {
+            int cell = queue[head];
+            int x = cell % width;
+            int y = cell / width;
+
+            component.area++;
+            component.min_x = std::min(component.min_x, x);
+            component.max_x = std::max(component.max_x, x);
+            component.min_y = std::min(component.min_y, y);
+            component.max_y = std::max(component.max_y, y);
+            if (data[cell] > data[component.representative])
+                component.representative = cell;
+
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny)
+            {
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+                {
+                    int neighbor = nx + ny * width;
+                    if (occupied[neighbor] && labels[neighbor] == -1)
+                    {
+                        labels[neighbor] = label;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+        }
+
+        relabeled_cells += queue.size();
+        components[label] = component;
+        markDirty(component);
+    }
+
+    void ObstacleLabeler::clearComponent(const int &label, std::vector<int> &cells)
+    {
+        int seed = components[label].representative;
+        if (seed == -1)
+            return;
+
+        //Walk the component through its old labels, it is still connected under the old occupancy
+        queue.clear();
+        queue.push_back(seed);
+        labels[seed] = -1;
+        for (int head = 0; head < static_cast<int>(queue.size()); ++head)
+        {
+            int cell = queue[head];
+            int x = cell % width;
+            int y = cell / width;
+            for (int ny = std::max(y - 1, 0); ny <= std::min(y + 1, height - 1); ++ny)
+            {
+                for (int nx = std::max(x - 1, 0); nx <= std::min(x + 1, width - 1); ++nx)
+                {
+                    int neighbor = nx + ny * width;
+                    if (labels[neighbor] == label)
+                    {
+                        labels[neighbor] = -1;
+                        queue.push_back(neighbor);
+                    }
+                }
+            }
+        }
+
+        cells.insert(cells.end(), queue.begin(), queue.end());
+        markDirty(components[label]);
+        components[label] = Component();
+        free_labels.push_back(label);
+    }
+
+    void ObstacleLabeler::markDirty(const Component &component)
+    {
+        if (dirty_min_x > dirty_max_x)
+        {
+            dirty_min_x = component.min_x;
+            dirty_min_y = component.min_y;
+            dirty_max_x = component.max_x;
+            dirty_max_y = component.max_y;
+            return;
+        }
+
+        dirty_min_x = std::min(dirty_min_x, component.min_x);
+        dirty_min_y = std::min(dirty_min_y, component.min_y);
+        dirty_max_x = std::max(dirty_max_x, component.max_x);
+        dirty_max_y = std::max(dirty_max_y, component.max_y);
+    }
+} // namespace voronoi_path
@@ -9,10 +9,13 @@
 #include <thread>
 #include <functional>
 #include <cmath>
+#include <queue>
+#include <atomic>
+#include <numeric>
 
 namespace voronoi_path
 {
-    VoronoiPath::VoronoiPath() : ebo(map_ptr)
+    VoronoiPath::VoronoiPath() : ebo(nullptr)
     {
     }
 
@@ -23,7 +26,7 @@ namespace voronoi_path
 
     uint32_t VoronoiPath::getUniqueID()
     {
-        static uint32_t id = 1;
+        static std::atomic<uint32_t> id(1);
         return id++;
     }
 
@@ -39,6 +42,8 @@ namespace voronoi_path
         ebo.equilibrium_relative_overshoot_ = equilibrium_relative_overshoot_;
         ebo.significant_force_ = significant_force_;
         ebo.costmap_weight_ = costmap_weight_;
+        ebo.jacobi_update_ = jacobi_update_;
+        ebo.converge_on_residual_ = converge_on_residual_;
     }
 
     std::vector<std::complex<double>> VoronoiPath::findObstacleCentroids()
@@ -46,49 +51,28 @@ namespace voronoi_path
         if (map_ptr->data.size() != 0)
         {
             Profiler profiler;
-            cv::Mat cv_map = cv::Mat(map_ptr->data).reshape(0, map_ptr->height);
-            cv_map.convertTo(cv_map, CV_8UC1);
 
             //Reset all centroid variables
             centers.clear();
             obs_coeff.clear();
 
-            //Downscale to increase contour finding speed
-            cv::resize(cv_map, cv_map, cv::Size(), open_cv_scale, open_cv_scale, cv::INTER_AREA);
+            //Label 8-connected groups of occupied cells, each group is one obstacle
+            if (incremental_obstacle_labeling)
+                obstacle_labeler.update(map_ptr->data, map_ptr->width, map_ptr->height, collision_threshold);
 
-            //Flip and transpose because image from map_server and actual map orientation is different
-            cv::flip(cv_map, cv_map, 1);
-            cv::transpose(cv_map, cv_map);
-            cv::flip(cv_map, cv_map, 1);
-            if (print_timings)
-                profiler.print("findObstacleCentroids copy map data");
-            
-            //Erode by 3px to increase chances of contour point lying in collision zone
-            cv::Mat structure_elem = cv::getStructuringElement(cv::MORPH_ELLIPSE, cv::Size(3, 3));
-            cv::erode(cv_map, cv_map, structure_elem);
+            else
+                obstacle_labeler.label(map_ptr->data, map_ptr->width, map_ptr->height, collision_threshold);
 
-            std::vector<std::vector<cv::Point>> contours;
-            std::vector<cv::Vec4i> hierarchy;
-            cv::Canny(cv_map, cv_map, 50, 150, 3);
-            cv::findContours(cv_map, contours, hierarchy, cv::RETR_LIST, cv::CHAIN_APPROX_NONE, cv::Point(0, 0));
-            centers = std::vector<std::complex<double>>(contours.size());
+            if (print_timings)
+                profiler.print("findObstacleCentroids label obstacles");
 
-            for (int i = 0; i < contours.size(); ++i)
-            {
-                //Find part of contour that lies on the inflation zone
-                for (int j = 0; j < contours[i].size(); ++j)
-                {
-                    centers[i] = std::complex<double>(map_ptr->width - contours[i][j].y / open_cv_scale, map_ptr->height - contours[i][j].x / open_cv_scale);
-                    if (map_ptr->data[floor(centers[i].real()) + floor(centers[i].imag()) * map_ptr->width] > collision_threshold)
-                        break;
+            //Merge small and nearby obstacles to limit the number of centers
+            std::vector<ObstacleLabeler::Component> components;
+            obstacle_labeler.getComponents(components);
+            clusterObstacles(components);
 
-                    if (j == contours[i].size() - 1)
-                    {
-                        // std::cout << "WARN: Could not find point on contour " << j << " which lies on the obstacle's inflation zone, path finding may not produce";
-                        // std::cout << " paths that are strictly in different homotopy classes\n ";
-                    }
-                }
-            }
+            if (print_timings)
+                profiler.print("findObstacleCentroids cluster obstacles");
 
             double a = (centers.size() - 1) / 2.0;
             double b = a;
@@ -117,8 +101,10 @@ namespace voronoi_path
                 }
             }
 
+            updateHomotopyObstacles();
+
             if (print_timings)
-                profiler.print("findObstacleCentroids find contour");
+                profiler.print("findObstacleCentroids calculate coefficients");
         }
 
         return centers;
@@ -150,6 +136,9 @@ namespace voronoi_path
         std::lock_guard<std::mutex> lock(voronoi_mtx);
         map_ptr = map_ptr_;
 
+        //Radius of elastic band bubbles is read from the map, which is only read while planning, possibly on several threads
+        map_ptr->robot_radius = robot_radius;
+
         if (print_timings)
             section_profiler.print("mapToGraph lock duration");
 
@@ -160,6 +149,12 @@ namespace voronoi_path
         if (size == 0)
             return false;
 
+        //Clearance around paths for contraction
+        distance_field.compute(map_ptr->data, map_ptr->width, map_ptr->height, trimming_collision_threshold);
+
+        if (print_timings)
+            section_profiler.print("mapToGraph compute distance field");
+
         //Set bottom left and top right for use during homotopy check
         BL = std::complex<double>(0, 0);
         TR = std::complex<double>(map_ptr->width - 1, map_ptr->height - 1);
@@ -258,10 +253,40 @@ namespace voronoi_path
 
         //Convert edges to adjacency list
         edgesToAdjacency(edge_vector);
+        graph_version++;
 
         if (print_timings)
-        {
             section_profiler.print("mapToGraph convert edges to adjacency");
+
+        //Precompute homotopy class contribution of every edge
+        computeEdgeHSignatures();
+
+        if (print_timings)
+            section_profiler.print("mapToGraph compute edge homotopy values");
+
+        //Precompute landmark distances for ALT heuristic
+        computeLandmarks();
+
+        if (print_timings)
+            section_profiler.print("mapToGraph compute landmarks");
+
+        //Preprocess graph for contraction hierarchy queries
+        if (use_contraction_hierarchy)
+            contraction_hierarchy.build(adj_list, node_inf);
+
+        else
+            contraction_hierarchy.clear();
+
+        if (print_timings)
+            section_profiler.print("mapToGraph build contraction hierarchy");
+
+        //Repair incremental search tree for the new graph, only nodes with changed edges are updated
+        if (use_incremental_search)
+            incremental_search.updateGraph(adj_list, node_inf);
+
+        if (print_timings)
+        {
+            section_profiler.print("mapToGraph update incremental search");
             complete_profiler.print("mapToGraph total time");
         }
 
@@ -455,6 +480,135 @@ namespace voronoi_path
         return sorted_node_list;
     }
 
+    void VoronoiPath::computeLandmarks()
+    {
+        landmark_dists.clear();
+        if (num_landmarks <= 0 || num_nodes == 0)
+            return;
+
+        //Minimum distance from every node to the landmarks selected so far
+        std::vector<double> min_dists(num_nodes, std::numeric_limits<double>::infinity());
+        std::vector<double> dist;
+
+        //Landmarks only bound distances within their own component, so seed from a node of the largest component
+        std::vector<int> component(num_nodes, -1);
+        std::vector<int> stack;
+        int seed = -1, seed_size = 0, num_connected = 0;
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (component[i] != -1)
+                continue;
+
+            int size = 0;
+            component[i] = i;
+            stack.push_back(i);
+            while (!stack.empty())
+            {
+                int curr = stack.back();
+                stack.pop_back();
+                size++;
+
+                for (const auto &next_node : adj_list[curr])
+                {
+                    if (next_node != -1 && component[next_node] == -1)
+                    {
+                        component[next_node] = i;
+                        stack.push_back(next_node);
+                    }
+                }
+            }
+
+            //Isolated nodes are never searched
+            if (size > 1)
+                num_connected += size;
+
+            if (size > seed_size)
+            {
+                seed = i;
+                seed_size = size;
+            }
+        }
+
+        //First landmark is the node furthest from the seed, subsequent landmarks maximize the distance to all selected landmarks
+        graphDistances(seed, dist);
+        for (int l = 0; l < num_landmarks; ++l)
+        {
+            int landmark = -1;
+            double furthest = -1;
+            for (int i = 0; i < num_nodes; ++i)
+            {
+                double d = (l == 0) ? dist[i] : min_dists[i];
+                if (d != std::numeric_limits<double>::infinity() && d > furthest)
+                {
+                    furthest = d;
+                    landmark = i;
+                }
+            }
+
+            //No more useful landmarks
+            if (landmark == -1 || furthest == 0)
+                break;
+
+            graphDistances(landmark, dist);
+            for (int i = 0; i < num_nodes; ++i)
+                min_dists[i] = std::min(min_dists[i], dist[i]);
+
+            landmark_dists.push_back(dist);
+        }
+
+        if (print_timings && !landmark_dists.empty() && seed_size < num_connected)
+            std::cout << "Landmarks cover " << seed_size << " of " << num_connected << " connected nodes, other components use the euclidean heuristic\n";
+    }
+
+    void VoronoiPath::graphDistances(const int &source, std::vector<double> &dist)
+    {
+        dist.assign(num_nodes, std::numeric_limits<double>::infinity());
+        dist[source] = 0;
+
+        //Min heap of (distance, node)
+        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> queue;
+        queue.emplace(0, source);
+
+        while (!queue.empty())
+        {
+            auto curr = queue.top();
+            queue.pop();
+
+            //Stale entry
+            if (curr.first > dist[curr.second])
+                continue;
+
+            for (const auto &next_node : adj_list[curr.second])
+            {
+                if (next_node == -1)
+                    continue;
+
+                double next_dist = curr.first + euclideanDist(node_inf[curr.second], node_inf[next_node]);
+                if (next_dist < dist[next_node])
+                {
+                    dist[next_node] = next_dist;
+                    queue.emplace(next_dist, next_node);
+                }
+            }
+        }
+    }
+
+    double VoronoiPath::heuristic(const int &node, const int &target)
+    {
+        double h = euclideanDist(node_inf[node], node_inf[target]);
+
+        //Triangle inequality bound from each landmark, skipping landmarks in other components
+        for (const auto &dists : landmark_dists)
+        {
+            if (dists[node] == std::numeric_limits<double>::infinity() || dists[target] == std::numeric_limits<double>::infinity())
+                continue;
+
+            h = std::max(h, std::fabs(dists[target] - dists[node]));
+        }
+
+        return h;
+    }
+
     bool VoronoiPath::getObstacleCentroids(std::vector<GraphNode> &centroids)
     {
         centroids.reserve(centers.size());
@@ -464,6 +618,165 @@ namespace voronoi_path
         return true;
     }
 
+    bool VoronoiPath::getObstacleClusters(std::vector<ObstacleCluster> &clusters)
+    {
+        clusters = obstacle_clusters;
+        return true;
+    }
+
+    void VoronoiPath::setRobotPosition(const GraphNode &position)
+    {
+        std::lock_guard<std::mutex> lock(robot_position_mtx);
+        robot_position = position;
+        robot_position_set = true;
+    }
+
+    void VoronoiPath::clusterObstacles(const std::vector<ObstacleLabeler::Component> &components)
+    {
+        //Highest cost cell of each obstacle lies in its collision zone. Center of the cell is used, a center at the origin
+        //would make all obstacle coefficients 0
+        auto cellToPoint = [this](const int &cell) {
+            return GraphNode(cell % map_ptr->width + 0.5, cell / map_ptr->width + 0.5);
+        };
+
+        int num_components = components.size();
+        std::vector<int> label_to_index;
+        for (int i = 0; i < num_components; ++i)
+        {
+            if (components[i].label >= label_to_index.size())
+                label_to_index.resize(components[i].label + 1, -1);
+
+            label_to_index[components[i].label] = i;
+        }
+
+        //Union find over components, joined if the gap between them is small enough. Path halving and union by size
+        //keep the trees flat
+        std::vector<int> parent(num_components);
+        std::vector<int> tree_size(num_components, 1);
+        std::iota(parent.begin(), parent.end(), 0);
+        auto findRoot = [&parent](int i) {
+            while (parent[i] != i)
+            {
+                parent[i] = parent[parent[i]];
+                i = parent[i];
+            }
+
+            return i;
+        };
+
+        std::vector<std::pair<int, int>> nearby_pairs;
+        obstacle_labeler.findNearbyPairs(obstacle_merge_gap, nearby_pairs);
+        for (const auto &pair : nearby_pairs)
+        {
+            int root_first = findRoot(label_to_index[pair.first]);
+            int root_second = findRoot(label_to_index[pair.second]);
+            if (root_first == root_second)
+                continue;
+
+            if (tree_size[root_first] < tree_size[root_second])
+                std::swap(root_first, root_second);
+
+            parent[root_second] = root_first;
+            tree_size[root_first] += tree_size[root_second];
+        }
+
+        //Build clusters, representative is the point of the largest component
+        std::vector<ObstacleCluster> clusters;
+        std::vector<int> largest_area;
+        std::vector<int> root_to_cluster(num_components, -1);
+        for (int i = 0; i < num_components; ++i)
+        {
+            int root = findRoot(i);
+            if (root_to_cluster[root] == -1)
+            {
+                root_to_cluster[root] = clusters.size();
+                clusters.emplace_back();
+                largest_area.push_back(0);
+            }
+
+            int c = root_to_cluster[root];
+            GraphNode point = cellToPoint(components[i].representative);
+            clusters[c].members.push_back(point);
+            clusters[c].area += components[i].area;
+            if (components[i].area > largest_area[c])
+            {
+                largest_area[c] = components[i].area;
+                clusters[c].representative = point;
+            }
+        }
+
+        //Small clusters are merged into the nearest cluster that is large enough
+        if (obstacle_merge_area > 0)
+        {
+            std::vector<ObstacleCluster> large_clusters;
+            std::vector<ObstacleCluster> small_clusters;
+            for (auto &cluster : clusters)
+            {
+                if (cluster.area >= obstacle_merge_area)
+                    large_clusters.push_back(std::move(cluster));
+
+                else
+                    small_clusters.push_back(std::move(cluster));
+            }
+
+            if (large_clusters.empty())
+            {
+                large_clusters = std::move(small_clusters);
+                small_clusters.clear();
+            }
+
+            for (auto &small : small_clusters)
+            {
+                int nearest = 0;
+                double nearest_dist = std::numeric_limits<double>::infinity();
+                for (int i = 0; i < large_clusters.size(); ++i)
+                {
+                    double dist = euclideanDist(small.representative, large_clusters[i].representative);
+                    if (dist < nearest_dist)
+                    {
+                        nearest_dist = dist;
+                        nearest = i;
+                    }
+                }
+
+                large_clusters[nearest].members.insert(large_clusters[nearest].members.end(), small.members.begin(), small.members.end());
+                large_clusters[nearest].area += small.area;
+            }
+
+            clusters = std::move(large_clusters);
+        }
+
+        //Keep only the top clusters, by area or by distance to robot
+        if (max_homotopy_obstacles > 0 && clusters.size() > max_homotopy_obstacles)
+        {
+            GraphNode robot;
+            bool rank_by_distance;
+            {
+                std::lock_guard<std::mutex> lock(robot_position_mtx);
+                robot = robot_position;
+                rank_by_distance = obstacle_rank_by_robot_distance && robot_position_set;
+            }
+
+            std::vector<std::pair<double, int>> ranks;
+            ranks.reserve(clusters.size());
+            for (int i = 0; i < clusters.size(); ++i)
+                ranks.emplace_back(rank_by_distance ? euclideanDist(clusters[i].representative, robot) : -clusters[i].area, i);
+
+            std::sort(ranks.begin(), ranks.end());
+            for (int i = max_homotopy_obstacles; i < ranks.size(); ++i)
+                clusters[ranks[i].second].kept = false;
+        }
+
+        obstacle_clusters = std::move(clusters);
+        centers.clear();
+        centers.reserve(obstacle_clusters.size());
+        for (const auto &cluster : obstacle_clusters)
+        {
+            if (cluster.kept)
+                centers.emplace_back(cluster.representative.x, cluster.representative.y);
+        }
+    }
+
     std::vector<double> VoronoiPath::getAllPathCosts()
     {
         return previous_path_costs;
@@ -522,7 +835,17 @@ namespace voronoi_path
         return hashed_int;
     }
 
-    bool VoronoiPath::interpolateContractPaths(std::vector<Path> &paths, bool allow_inflation)
+    uint64_t VoronoiPath::hashPath(const std::vector<int> &path)
+    {
+        //Polynomial rolling hash over node numbers, overflow wraps modulo 2^64
+        uint64_t hashed = 1469598103934665603ULL;
+        for (const auto &node : path)
+            hashed = hashed * 1099511628211ULL + static_cast<uint64_t>(node + 1);
+
+        return hashed;
+    }
+
+    bool VoronoiPath::interpolateContractPaths(std::vector<Path> &paths, bool allow_inflation, bool any_warm_band, int max_threads, bool find_stuck_vertex)
     {
         //Increase resolution of paths by interpolation before contracting to give smoother result
         interpolatePaths(paths, path_waypoint_sep);
@@ -532,7 +855,7 @@ namespace voronoi_path
             {
                 contractPath(path.path, allow_inflation);
 
-                if(!backtrack_paths)
+                if(find_stuck_vertex)
                     findStuckVertex(path.path);
             }
         }
@@ -540,40 +863,128 @@ namespace voronoi_path
         //Use eband
         else
         {
-            for (int i = 0; i < paths.size(); ++i)
+            //Bands of the last planning cycle, bands stored by the workers are only used in the next cycle
+            std::map<uint32_t, eband_optimizer::Band> last_bands;
+            if (warm_start_elastic_band)
             {
-                std::vector<geometry_msgs::PoseStamped> global_plan;
-                std::vector<GraphNode> new_path;
+                std::lock_guard<std::mutex> lock(warm_bands_mtx);
+                last_bands = warm_bands;
+            }
 
-                //Convert to map frame plan
-                for(const auto &pose : paths[i].path)
-                {
-                    geometry_msgs::PoseStamped new_pose;
-                    new_pose.header.frame_id = map_ptr->frame_id;
-                    map_ptr->mapToWorld(pose.x, pose.y, new_pose.pose.position.x, new_pose.pose.position.y);
-                    new_pose.pose.orientation.w = 1.0;
-                    global_plan.push_back(std::move(new_pose));
-                }
+            //Eband time is that of the slowest path instead of the sum of all paths
+            int thread_budget = std::max<int>(std::thread::hardware_concurrency(), 1);
+            if (max_threads > 0)
+                thread_budget = std::min(thread_budget, max_threads);
 
-                map_ptr->robot_radius = robot_radius;
-                ebo.setPlan(global_plan, map_ptr);
-                ebo.optimizeBand();
-                ebo.getPlan(global_plan);
+            int num_threads = std::min<int>(thread_budget, paths.size());
 
-                for(const auto &pose : global_plan)
+            //Optimization cycles and largest remaining force of every path, printed once all workers are done
+            std::vector<int> num_iterations(paths.size(), 0);
+            std::vector<double> residuals(paths.size(), 0);
+
+            //Workers take the next unoptimized path until all paths are done. Each has its own copy of the configured
+            //optimizer, as the optimizer stores the band being optimized. Threads left over by the workers are shared
+            //among their optimizers
+            std::atomic<int> next_path(0);
+            auto worker = [&]() {
+                eband_optimizer::EBandOptimizer optimizer(ebo);
+                optimizer.setDistanceField(&distance_field);
+                optimizer.setMaxThreads(std::max(thread_budget / std::max(num_threads, 1), 1));
+
+                std::vector<geometry_msgs::PoseStamped> global_plan;
+                eband_optimizer::Band band;
+                for (int i = next_path++; i < paths.size(); i = next_path++)
                 {
-                    GraphNode new_node;
-                    map_ptr->worldToMap(pose.pose.position.x, pose.pose.position.y, new_node.x, new_node.y);
-                    new_path.push_back(std::move(new_node));
+                    //Convert to map frame plan
+                    global_plan.clear();
+                    for(const auto &pose : paths[i].path)
+                    {
+                        geometry_msgs::PoseStamped new_pose;
+                        new_pose.header.frame_id = map_ptr->frame_id;
+                        map_ptr->mapToWorld(pose.x, pose.y, new_pose.pose.position.x, new_pose.pose.position.y);
+                        new_pose.pose.orientation.w = 1.0;
+                        global_plan.push_back(std::move(new_pose));
+                    }
+
+                    //Start from the band of the same path of the last planning cycle if the path still follows it.
+                    //Otherwise try the bands of the other paths if allowed
+                    bool warm_started = false;
+                    if (warm_start_elastic_band)
+                    {
+                        auto it = last_bands.find(paths[i].id);
+                        warm_started = it != last_bands.end() && optimizer.setPlan(global_plan, map_ptr, it->second);
+                        for (auto other = last_bands.begin(); any_warm_band && !warm_started && other != last_bands.end(); ++other)
+                            warm_started = other != it && optimizer.setPlan(global_plan, map_ptr, other->second);
+                    }
+
+                    if (!warm_started)
+                        optimizer.setPlan(global_plan, map_ptr);
+
+                    optimizer.optimizeBand();
+                    optimizer.getPlan(global_plan);
+                    num_iterations[i] = optimizer.getNumIterations();
+                    residuals[i] = optimizer.getResidual();
+
+                    if (warm_start_elastic_band && optimizer.getBand(band))
+                    {
+                        std::lock_guard<std::mutex> lock(warm_bands_mtx);
+                        warm_bands[paths[i].id] = band;
+                    }
+
+                    std::vector<GraphNode> new_path;
+                    new_path.reserve(global_plan.size());
+                    for(const auto &pose : global_plan)
+                    {
+                        GraphNode new_node;
+                        map_ptr->worldToMap(pose.pose.position.x, pose.pose.position.y, new_node.x, new_node.y);
+                        new_path.push_back(std::move(new_node));
+                    }
+
+                    paths[i].path = std::move(new_path);
                 }
+            };
+
+            if (num_threads <= 1)
+                worker();
+
+            else
+            {
+                std::vector<std::future<void>> future_vector;
+                future_vector.reserve(num_threads);
+                for (int i = 0; i < num_threads; ++i)
+                    future_vector.emplace_back(std::async(std::launch::async, worker));
+
+                for (auto &future : future_vector)
+                    future.get();
+            }
 
-                paths[i].path = std::move(new_path);
+            if (print_timings)
+            {
+                for (int i = 0; i < paths.size(); ++i)
+                    std::cout << "Path " << paths[i].id << " elastic band iterations: " << num_iterations[i] << " residual: " << residuals[i] << "\n";
             }
         }
 
         return true;
     }
 
+    void VoronoiPath::pruneWarmBands()
+    {
+        std::lock_guard<std::mutex> lock(warm_bands_mtx);
+        for (auto it = warm_bands.begin(); it != warm_bands.end();)
+        {
+            bool previous = std::any_of(previous_paths.begin(), previous_paths.end(), [&it](const Path &path) {
+                return path.id == it->first;
+            });
+
+            if (!previous)
+                it = warm_bands.erase(it);
+
+            else
+                ++it;
+        }
+    }
+
     bool VoronoiPath::findStuckVertex(std::vector<GraphNode> &path)
     {
         // for(int j = 1; j < path.size() - 1; ++j)
@@ -647,147 +1058,251 @@ namespace voronoi_path
 
     bool VoronoiPath::contractPath(std::vector<GraphNode> &path, bool allow_inflation)
     {
-        //Calculate minimum distance between two poses in path should have, distance in pix squared
-        double waypoint_sep_sq = path_waypoint_sep * path_waypoint_sep / map_ptr->resolution / map_ptr->resolution;
-
-        //Anchor node that is being used to check for collision
-        int anchor_node = 0;
+        //Points in inflation cannot be part of the path unless inflation is allowed, start and end are always kept
+        if (!allow_inflation)
+        {
+            for (int i = 1; i < static_cast<int>(path.size()) - 1;)
+            {
+                if (edgeCollides(path[i], path[i], trimming_collision_threshold))
+                {
+                    std::cout << "Self collision waypoint detected, erasing node " << i << "\n";
+                    path.erase(path.begin() + i);
+                }
 
-        //Anchor node that should be used for the next iteration
-        int future_anchor_node = 0;
+                else
+                    ++i;
+            }
+        }
 
-        //Used to store previous collision node for use during finding of next collision node
-        int prev_collision_node = -1;
+        if (path.size() < 3 || !distance_field.matches(map_ptr->width, map_ptr->height))
+            return true;
 
-        //While anchor node has not reached the last node
-        while (anchor_node < path.size() - 1)
+        //Portals of the first pass follow the bends of the Voronoi edges and cross each other in sharp turns, the second
+        //pass runs on the straightened path where portals line up with the final direction
+        double max_clearance = std::max(map_ptr->width, map_ptr->height);
+        double waypoint_sep = path_waypoint_sep / map_ptr->resolution;
+        for (int pass = 0; pass < 2; ++pass)
         {
-            //From anchor_node, traverse path until there is a collision, set that as the collision node
-            //Trim nodes except start and end nodes
-            int i;
-
-            //Connected node is the node that anchor_node will be joined to
-            int connected_node = path.size() - 1;
-
-            //Index of node that collides with the anchor node
-            int collision_node = path.size() - 1;
-            for (i = prev_collision_node != -1 ? prev_collision_node : anchor_node; i < path.size(); ++i)
+            //Clearance of every point, the margin keeps portal ends out of cells next to obstacle cells
+            std::vector<double> clearance(path.size());
+            for (int i = 0; i < path.size(); ++i)
+                clearance[i] = std::max(std::min(distance_field.getDistance(path[i].x, path[i].y) - 1.5, max_clearance), 0.0);
+
+            //Points of the path sorted into a grid over their bounding box, so that the points close to a point are found
+            //without scanning the whole path
+            double cell_size = 4 * std::max(waypoint_sep, 1.0);
+            double min_x = path[0].x, min_y = path[0].y, max_x = path[0].x, max_y = path[0].y;
+            for (const auto &point : path)
             {
-                //If collision with node i occurs, then set the connected point as the node before i
-                if (edgeCollides(path[anchor_node], path[i], trimming_collision_threshold))
-                {
-                    collision_node = i;
-                    connected_node = i - 1;
-                    break;
-                }
+                min_x = std::min(min_x, point.x);
+                min_y = std::min(min_y, point.y);
+                max_x = std::max(max_x, point.x);
+                max_y = std::max(max_y, point.y);
             }
 
-            //Remove self collision node
-            if(collision_node == anchor_node)
+            int grid_width = static_cast<int>((max_x - min_x) / cell_size) + 1;
+            int grid_height = static_cast<int>((max_y - min_y) / cell_size) + 1;
+            auto cellOf = [&](const GraphNode &point) {
+                return static_cast<int>((point.x - min_x) / cell_size) + static_cast<int>((point.y - min_y) / cell_size) * grid_width;
+            };
+
+            std::vector<int> cell_start(grid_width * grid_height + 1, 0);
+            for (const auto &point : path)
+                cell_start[cellOf(point) + 1]++;
+
+            std::partial_sum(cell_start.begin(), cell_start.end(), cell_start.begin());
+            std::vector<int> cell_points(path.size());
+            std::vector<int> cell_fill(cell_start.begin(), cell_start.end() - 1);
+            for (int j = 0; j < path.size(); ++j)
+                cell_points[cell_fill[cellOf(path[j])]++] = j;
+
+            //Remove loops and dead ends, the path jumps to the last point that lies in the free disc around the current point.
+            //Jumps are filled with points at waypoint separation so that portals stay dense
+            std::vector<GraphNode> corridor;
+            std::vector<double> corridor_clearance;
+            corridor.reserve(path.size());
+            corridor_clearance.reserve(path.size());
+            for (int i = 0; i < path.size();)
             {
-                if(allow_inflation)
+                corridor.push_back(path[i]);
+                corridor_clearance.push_back(clearance[i]);
+
+                int next = i + 1;
+                double clearance_sq = clearance[i] * clearance[i];
+                int cell_x0 = std::max(static_cast<int>((path[i].x - clearance[i] - min_x) / cell_size), 0);
+                int cell_x1 = std::min(static_cast<int>((path[i].x + clearance[i] - min_x) / cell_size), grid_width - 1);
+                int cell_y0 = std::max(static_cast<int>((path[i].y - clearance[i] - min_y) / cell_size), 0);
+                int cell_y1 = std::min(static_cast<int>((path[i].y + clearance[i] - min_y) / cell_size), grid_height - 1);
+                for (int cell_y = cell_y0; cell_y <= cell_y1 && clearance_sq > 0; ++cell_y)
                 {
-                    anchor_node++;
-                    prev_collision_node = -1;
+                    for (int cell_x = cell_x0; cell_x <= cell_x1; ++cell_x)
+                    {
+                        int cell = cell_x + cell_y * grid_width;
+                        for (int k = cell_start[cell]; k < cell_start[cell + 1]; ++k)
+                        {
+                            //Only jump along the direction the path continues in after point j, so portals keep their orientation
+                            int j = cell_points[k];
+                            if (j <= next)
+                                continue;
+
+                            GraphNode diff = path[j] - path[i];
+                            GraphNode tangent = path[std::min(j + 1, static_cast<int>(path.size()) - 1)] - path[j - 1];
+                            if (diff.x * diff.x + diff.y * diff.y < clearance_sq && diff.x * tangent.x + diff.y * tangent.y > 0)
+                                next = j;
+                        }
+                    }
                 }
 
-                else
+                if (next > i + 1)
                 {
-                    if(anchor_node > 0)
-                        anchor_node--;
-                    std::cout << "Self collision waypoint detected, erasing node " << collision_node << "\n";
-                    path.erase(path.begin() + collision_node);
-                    prev_collision_node = -1;
+                    GraphNode diff = path[next] - path[i];
+                    int steps = std::ceil(diff.getMagnitude() / waypoint_sep);
+                    for (int step = 1; step < steps; ++step)
+                    {
+                        corridor.push_back(path[i] + diff * (static_cast<double>(step) / steps));
+                        const GraphNode &point = corridor.back();
+                        corridor_clearance.push_back(std::max(std::min(distance_field.getDistance(point.x, point.y) - 1.5, max_clearance), 0.0));
+                    }
                 }
 
-                continue;
+                i = next;
             }
 
-            //Preemptively set future_anchor_node, if another is found later on, this will be corrected
-            future_anchor_node = collision_node;
+            std::vector<GraphNode> corners;
+            pullTaut(corridor, corridor_clearance, corridor.front(), 0, corridor.back(), corridor.size() - 1, 1.0, corners);
 
-            //Between anchor_node and connected_node, project point onto straight line connection anchor node to collision node - 1
-            //Project trimmable poses on the path onto the straight line between anchor_node and connected_point
-            double gradient, inv_gradient;
-            try
+            //Waypoints are placed along straight segments at the same separation as interpolation
+            std::vector<GraphNode> contracted;
+            contracted.reserve(path.size());
+            contracted.push_back(corridor.front());
+            for (const auto &corner : corners)
             {
-                gradient = (path[anchor_node].y - path[connected_node].y) / (path[anchor_node].x - path[connected_node].x);
-                inv_gradient = -1.0 / gradient;
-            }
-            catch (std::exception &e)
-            {
-                std::cout << "Calculate gradient exception: " << e.what() << "\n";
-            }
+                GraphNode from = contracted.back();
+                GraphNode diff = corner - from;
+                if (diff.x == 0 && diff.y == 0)
+                    continue;
 
-            //Project points between anchor_node and connected_node (exclusive) onto the line joining anchor_node and connected_node
-            for (int j = anchor_node + 1; j < connected_node; ++j)
-            {
-                if (j >= path.size())
-                    break;
+                int steps = std::max(static_cast<int>(std::ceil(diff.getMagnitude() / waypoint_sep)), 1);
+                for (int step = 1; step <= steps; ++step)
+                    contracted.push_back(from + diff * (static_cast<double>(step) / steps));
+            }
 
-                //Gradient is 0, shift point j's y coord to anchor_node's level
-                if (gradient == 0.0)
-                    path[j].y = path[anchor_node].y;
+            path = std::move(contracted);
+        }
 
-                //Gradient infinity, shit point j's x coord to anchor_node's level
-                else if (fabs(gradient) == std::numeric_limits<double>::infinity())
-                    path[j].x = path[anchor_node].x;
+        return true;
+    }
 
-                //Valid gradient, project as normal
-                else
-                {
-                    //Project points onto the straight line
-                    //y = mx + c =====> c = y - mx
-                    //(a)x + (1)y = c =====> a = -m
-                    double c1 = path[connected_node].y - gradient * path[connected_node].x;
-                    double c2 = path[j].y - inv_gradient * path[j].x;
-                    double a1 = -gradient;
-                    double a2 = -inv_gradient;
-                    double determinant = a1 - a2;
-
-                    if(determinant == 0.0)
-                        std::cout << "Point projection has 0 determinant\n";
+    void VoronoiPath::pullTaut(const std::vector<GraphNode> &corridor, const std::vector<double> &clearance, const GraphNode &start, const int &start_index,
+                               const GraphNode &end, const int &end_index, const double &scale, std::vector<GraphNode> &corners)
+    {
+        //Portal of every point spans its clearance on both sides, perpendicular to the path. Start and end portals are points
+        int n = end_index - start_index + 1;
+        std::vector<GraphNode> left(n), right(n);
+        left[0] = right[0] = start;
+        left[n - 1] = right[n - 1] = end;
+        for (int k = 1; k < n - 1; ++k)
+        {
+            int i = start_index + k;
+            left[k] = right[k] = corridor[i];
 
-                    else
-                    {
-                        path[j].x = (c1 - c2) / determinant;
-                        path[j].y = (a1 * c2 - a2 * c1) / determinant;
-                    }
-                }
+            GraphNode tangent = corridor[i + 1] - corridor[i - 1];
+            double tangent_mag = tangent.getMagnitude();
+            if (tangent_mag == 0)
+                continue;
 
-                //If point is not on segment between anchor point and connected point, delete the point
-                double dist = pow(path[j].x - path[j - 1].x, 2) + pow(path[j].y - path[j - 1].y, 2);
+            double radius = clearance[i] * scale;
+            GraphNode normal(-tangent.y / tangent_mag * radius, tangent.x / tangent_mag * radius);
+            left[k] = corridor[i] + normal;
+            right[k] = corridor[i] - normal;
+        }
 
-                if (!liesInSquare(path[j], path[anchor_node], path[connected_node]) || (dist < waypoint_sep_sq))
+        //Positive if c is to the left of the line from a to b
+        auto cross = [](const GraphNode &a, const GraphNode &b, const GraphNode &c) {
+            return (b.x - a.x) * (c.y - a.y) - (b.y - a.y) * (c.x - a.x);
+        };
+
+        //Funnel algorithm, the funnel is the apex and the tightest left and right portal ends seen since the apex.
+        //When a side crosses over the other, the other side becomes the new apex
+        std::vector<int> apexes{0};
+        std::vector<GraphNode> apex_points{start};
+        GraphNode apex = start, funnel_left = start, funnel_right = start;
+        int apex_index = 0, left_index = 0, right_index = 0;
+        for (int k = 1; k < n; ++k)
+        {
+            //Right side moves inwards
+            if (cross(apex, funnel_right, right[k]) >= 0)
+            {
+                if (apex == funnel_right || cross(apex, funnel_left, right[k]) < 0)
                 {
-                    //Decrement post deletion because the for loop will increment this again later
-                    j = std::distance(path.begin(), path.erase(path.begin() + j)) - 1;
-
-                    //Decrement connected_node, future_anchor_node, collision_node because a node before connected_node has been erased
-                    --connected_node;
-                    --collision_node;
-                    --future_anchor_node;
+                    funnel_right = right[k];
+                    right_index = k;
+                }
 
+                else
+                {
+                    apex = funnel_right = funnel_left;
+                    apex_index = right_index = left_index;
+                    apexes.push_back(apex_index);
+                    apex_points.push_back(apex);
+                    k = apex_index;
                     continue;
                 }
+            }
 
-                // Also find the future anchor node, definition of future anchor node is the node that can be connected to collision node, without collision
-                // If currently modified node has no collision with collision node, then it is the future anchor, break once set
-                if (!edgeCollides(path[j], path[collision_node], trimming_collision_threshold))
+            //Left side moves inwards
+            if (cross(apex, funnel_left, left[k]) <= 0)
+            {
+                if (apex == funnel_left || cross(apex, funnel_right, left[k]) > 0)
                 {
-                    future_anchor_node = j;
-                    break;
+                    funnel_left = left[k];
+                    left_index = k;
+                }
+
+                else
+                {
+                    apex = funnel_left = funnel_right;
+                    apex_index = left_index = right_index;
+                    apexes.push_back(apex_index);
+                    apex_points.push_back(apex);
+                    k = apex_index;
+                    continue;
                 }
             }
+        }
 
-            prev_collision_node = collision_node;
-            anchor_node = future_anchor_node;
+        if (apexes.back() != n - 1)
+        {
+            apexes.push_back(n - 1);
+            apex_points.push_back(end);
         }
 
-        return true;
-    }
+        //One collision check per segment. Colliding segments are pulled again with portals of half the width, up to 2
+        //times, then go back to the points of the portals they span
+        for (int j = 1; j < apexes.size(); ++j)
+        {
+            const GraphNode &from = apex_points[j - 1];
+            const GraphNode &to = apex_points[j];
+            int from_index = start_index + apexes[j - 1];
+            int to_index = start_index + apexes[j];
 
-    void VoronoiPath::backtrack(std::vector<int> &path, double cur_dist, const int &prev_node, const int &cur_node, std::vector<std::vector<int>> &paths, const double &backtrack_plan_threshold)
+            if (!edgeCollides(from, to, trimming_collision_threshold))
+                corners.push_back(to);
+
+            else if (scale > 0.25 && to_index - from_index > 1)
+                pullTaut(corridor, clearance, from, from_index, to, to_index, scale * 0.5, corners);
+
+            else
+            {
+                for (int i = from_index; i <= to_index; ++i)
+                    corners.push_back(corridor[i]);
+
+                corners.push_back(to);
+            }
+        }
+    }
+
+    void VoronoiPath::backtrack(std::vector<int> &path, double cur_dist, const int &prev_node, const int &cur_node, std::vector<std::vector<int>> &paths, const double &backtrack_plan_threshold)
     {
         //Add cur_node to path
         path.push_back(cur_node);
@@ -881,15 +1396,15 @@ namespace voronoi_path
                 return true;
         }
 
-        //Copy and append onto path1
+        //Path 1 extended by the connection from its end to path 2's end, and by path 2's start in front
+        interp_connection.insert(interp_connection.begin(), path1->path.back());
         interp_connection.push_back(path2->path.back());
-        auto path1_copy = path1->path;
-        path1_copy.insert(path1_copy.end(), interp_connection.begin(), interp_connection.end());
-        path1_copy.insert(path1_copy.begin(), path2->path.front());
 
-        //Calculate homotopy
-        auto path1_homotopy = calcHomotopyClass(path1_copy);
-        auto path2_homotopy = calcHomotopyClass(path2->path);
+        //Calculate homotopy by joining the cached class of path 1 with the classes of the connections
+        HomotopyClass path1_homotopy = getHomotopyClass(std::vector<GraphNode>{path2->path.front(), path1->path.front()});
+        appendHomotopyClass(path1_homotopy, getPathHomotopyClass(*path1));
+        appendHomotopyClass(path1_homotopy, getHomotopyClass(interp_connection));
+        const HomotopyClass &path2_homotopy = getPathHomotopyClass(*path2);
 
         //If homotopy is not distinct
         if(isClassDifferent(path1_homotopy, path2_homotopy))
@@ -936,6 +1451,7 @@ namespace voronoi_path
         //Block until voronoi is no longer being updated. Prevents issue where planning is done using an empty adjacency list
         std::lock_guard<std::mutex> lock(voronoi_mtx);
         Profiler complete_profiler, section_profiler;
+        bool backtrack_paths = false;
         
         //Compensate previous path's map origin
         if(prev_map.frame_id != "")
@@ -995,7 +1511,9 @@ namespace voronoi_path
                 all_path_nodes[i].path.emplace_back(node_inf[node].x, node_inf[node].y);
         }
 
-        interpolateContractPaths(all_path_nodes, true);
+        //Paths get the ids of previous paths only after contraction, so their bands are warm started from the band of
+        //any previous path they follow
+        interpolateContractPaths(all_path_nodes, true, true, 0, !backtrack_paths);
 
         if(print_timings)
             section_profiler.print("backtrackPlan interpolate and contract");
@@ -1103,10 +1621,28 @@ namespace voronoi_path
         //Otherwise, try to link previous and current paths 
         else
         {
+            std::vector<uint32_t> unlinked_ids;
+            for (const auto &path : all_path_nodes)
+                unlinked_ids.push_back(path.id);
+
             viz_paths = linkBacktrackPaths(previous_paths, all_path_nodes);
             previous_paths = all_path_nodes;
+
+            //Bands were stored under the ids the paths had before linking
+            std::lock_guard<std::mutex> warm_lock(warm_bands_mtx);
+            for (int i = 0; i < all_path_nodes.size(); ++i)
+            {
+                auto it = warm_bands.find(unlinked_ids[i]);
+                if (all_path_nodes[i].id != unlinked_ids[i] && it != warm_bands.end())
+                {
+                    warm_bands[all_path_nodes[i].id] = std::move(it->second);
+                    warm_bands.erase(it);
+                }
+            }
         }
 
+        pruneWarmBands();
+
         if(print_timings)
             complete_profiler.print("backtrackPlan total time");
 
@@ -1203,13 +1739,25 @@ namespace voronoi_path
 
 
     std::vector<Path> VoronoiPath::getPath(const GraphNode &start, const GraphNode &end, const int &num_paths)
+    {
+        bool partial;
+        return getPath(start, end, num_paths, 0, partial);
+    }
+
+    std::vector<Path> VoronoiPath::getPath(const GraphNode &start, const GraphNode &end, const int &num_paths, const double &time_budget, bool &partial)
     {
         //Block until voronoi is no longer being updated. Prevents issue where planning is done using an empty adjacency list
         std::lock_guard<std::mutex> lock(voronoi_mtx);
 
+        //Deadline only applies to the search for alternative paths, shortest path is always found. Time waiting for a
+        //map update is not part of the budget
+        std::chrono::steady_clock::time_point deadline = std::chrono::steady_clock::now() +
+                                                         std::chrono::duration_cast<std::chrono::steady_clock::duration>(std::chrono::duration<double>(time_budget));
+        const std::chrono::steady_clock::time_point *deadline_ptr = time_budget > 0 ? &deadline : nullptr;
+        partial = false;
+
         Profiler complete_profiler, section_profiler;
         std::vector<Path> path;
-        backtrack_paths = false;
 
         //Find nearest node to starting and end positions
         int start_node, end_node;
@@ -1219,8 +1767,19 @@ namespace voronoi_path
         if (print_timings)
             section_profiler.print("getPath find nearest node");
 
+        //Continue Yen's algorithm from the previous call if it was for the same nodes on the same graph
+        bool resume_yen = alternative_path_method == AlternativePathMethod::YEN && yen_state.start_node == start_node &&
+                          yen_state.end_node == end_node && yen_state.graph_version == graph_version && !yen_state.kthPaths.empty();
+
         std::vector<int> shortest_path;
-        if (findShortestPath(start_node, end_node, shortest_path))
+        bool found = true;
+        if (resume_yen)
+            shortest_path = yen_state.kthPaths[0];
+
+        else
+            found = use_incremental_search ? findIncrementalPath(start_node, end_node, shortest_path) : findShortestPath(start_node, end_node, shortest_path);
+
+        if (found)
         {
             if (print_timings)
                 section_profiler.print("getPath find shortest path");
@@ -1228,33 +1787,28 @@ namespace voronoi_path
             std::vector<std::vector<int>> all_paths;
             //Get next shortest path
             if (num_paths >= 1)
-                kthShortestPaths(start_node, end_node, shortest_path, all_paths, num_paths - 1);
-
-            if (print_timings)
-                section_profiler.print("getPath find kth shortest paths");
-
-            //Copy all_paths into new container which include start and end
-            std::vector<Path> all_path_nodes;
-            all_path_nodes.reserve(all_paths.size());
-            for (int i = 0; i < all_paths.size(); ++i)
             {
-                all_path_nodes.emplace_back(getUniqueID(), std::vector<GraphNode>{start});
-                all_path_nodes[i].path.reserve(all_paths[i].size() + 2);
+                if (alternative_path_method == AlternativePathMethod::YEN)
+                {
+                    if (!resume_yen)
+                        resetYenState(yen_state, start_node, end_node, shortest_path);
 
-                for (const auto &node : all_paths[i])
-                    all_path_nodes[i].path.emplace_back(node_inf[node].x, node_inf[node].y);
+                    if (!kthShortestPaths(yen_state, all_paths, num_paths - 1, nullptr, deadline_ptr))
+                        partial = !yen_state.exhausted;
+                }
 
-                all_path_nodes[i].path.push_back(end);
+                else if (!penaltyShortestPaths(start_node, end_node, shortest_path, all_paths, num_paths - 1, nullptr, deadline_ptr))
+                    partial = deadline_ptr && std::chrono::steady_clock::now() >= deadline;
             }
 
             if (print_timings)
-                section_profiler.print("getPath insert start and end");
+                section_profiler.print("getPath find kth shortest paths");
 
-            //Trim beginning of path to remove unnecessary u-turns in path
-            interpolateContractPaths(all_path_nodes);
+            //Insert start and end, then interpolate and contract paths
+            std::vector<Path> all_path_nodes = nodePathsToPaths(all_paths, start, end);
 
             if (print_timings)
-                section_profiler.print("getPath interpolate and contract");
+                section_profiler.print("getPath insert start and end, interpolate and contract");
 
             //Only set previous paths and their costs if this was the first getPath call
             if (!hasPreviousPaths())
@@ -1274,6 +1828,8 @@ namespace voronoi_path
                 std::swap(previous_path_costs[0], previous_path_costs[ind]);
                 std::swap(all_path_nodes[0], all_path_nodes[ind]);
 
+                pruneWarmBands();
+
                 if (print_timings)
                     section_profiler.print("getPath get all initial costs");
             }
@@ -1290,6 +1846,169 @@ namespace voronoi_path
         return path;
     }
 
+    std::vector<std::vector<Path>> VoronoiPath::getPaths(const GraphNode &start, const std::vector<GraphNode> &goals, const int &num_paths)
+    {
+        //Block until voronoi is no longer being updated
+        std::lock_guard<std::mutex> lock(voronoi_mtx);
+
+        Profiler complete_profiler, section_profiler;
+        std::vector<std::vector<Path>> paths(goals.size());
+
+        //Find nearest nodes to start and all goals in one pass
+        int start_node;
+        std::vector<int> goal_nodes;
+        if (!getNearestNodes(start, goals, start_node, goal_nodes))
+            return paths;
+
+        if (print_timings)
+            section_profiler.print("getPaths find nearest nodes");
+
+        //One search shared by the shortest paths of all goals
+        std::vector<int> prev;
+        shortestPathTree(start_node, goal_nodes, prev);
+
+        if (print_timings)
+            section_profiler.print("getPaths shortest path tree");
+
+        for (int g = 0; g < goals.size(); ++g)
+        {
+            if (goal_nodes[g] == -1)
+                continue;
+
+            //Backtrack shortest path from tree
+            std::vector<int> shortest_path;
+            for (int node = goal_nodes[g]; node != -1; node = prev[node])
+                shortest_path.push_back(node);
+
+            if (shortest_path.back() != start_node)
+            {
+                std::cout << "Path could not be found to goal " << g << std::endl;
+                continue;
+            }
+
+            std::reverse(shortest_path.begin(), shortest_path.end());
+
+            //Spur searches of Yen's algorithm and penalty searches change the graph, they cannot reuse the tree
+            std::vector<std::vector<int>> all_paths;
+            if (num_paths >= 1)
+                findAlternativePaths(start_node, goal_nodes[g], shortest_path, all_paths, num_paths - 1);
+
+            paths[g] = nodePathsToPaths(all_paths, start, goals[g]);
+
+            //Shortest path is first, contraction might have changed the order
+            moveShortestPathFirst(paths[g]);
+        }
+
+        //Paths to several goals are not replanned, their bands are not needed
+        pruneWarmBands();
+
+        if (print_timings)
+            complete_profiler.print("getPaths find all paths");
+
+        return paths;
+    }
+
+    std::vector<std::vector<Path>> VoronoiPath::getPathsBatch(const std::vector<PathQuery> &queries)
+    {
+        //Graph is only read during the batch, hold the lock so that it is not regenerated halfway
+        std::lock_guard<std::mutex> lock(voronoi_mtx);
+
+        Profiler complete_profiler;
+        std::vector<std::vector<Path>> paths(queries.size());
+
+        //Workers take the next unprocessed query until all queries are done
+        std::atomic<int> next_query(0);
+        auto worker = [&]() {
+            SearchWorkspace workspace;
+            for (int q = next_query++; q < queries.size(); q = next_query++)
+            {
+                workspace.mode = queries[q].search_mode;
+
+                int start_node, end_node;
+                if (!getNearestNode(queries[q].start, queries[q].end, start_node, end_node))
+                    continue;
+
+                std::vector<int> shortest_path;
+                if (!findShortestPath(start_node, end_node, shortest_path, nullptr, &workspace))
+                    continue;
+
+                std::vector<std::vector<int>> all_paths;
+                if (queries[q].num_paths >= 1)
+                    findAlternativePaths(start_node, end_node, shortest_path, all_paths, queries[q].num_paths - 1, &workspace);
+
+                //Queries already run in parallel, their bands are optimized on the worker thread
+                paths[q] = nodePathsToPaths(all_paths, queries[q].start, queries[q].end, 1);
+
+                //Shortest path is first, contraction might have changed the order
+                moveShortestPathFirst(paths[q]);
+            }
+        };
+
+        int num_threads = std::min<int>(std::max<int>(std::thread::hardware_concurrency(), 1), queries.size());
+        std::vector<std::future<void>> future_vector;
+        future_vector.reserve(num_threads);
+        for (int i = 0; i < num_threads; ++i)
+            future_vector.emplace_back(std::async(std::launch::async, worker));
+
+        for (auto &future : future_vector)
+            future.get();
+
+        //Batch paths are not replanned, their bands are not needed
+        pruneWarmBands();
+
+        if (print_timings)
+            complete_profiler.print("getPathsBatch total time");
+
+        return paths;
+    }
+
+    bool VoronoiPath::findAlternativePaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace)
+    {
+        if (alternative_path_method == AlternativePathMethod::PENALTY)
+            return penaltyShortestPaths(start_node, end_node, shortestPath, all_paths, num_paths, workspace);
+
+        else
+            return kthShortestPaths(start_node, end_node, shortestPath, all_paths, num_paths, workspace);
+    }
+
+    std::vector<Path> VoronoiPath::nodePathsToPaths(const std::vector<std::vector<int>> &all_paths, const GraphNode &start, const GraphNode &end, int max_threads)
+    {
+        //Copy all_paths into new container which include start and end
+        std::vector<Path> all_path_nodes;
+        all_path_nodes.reserve(all_paths.size());
+        for (int i = 0; i < all_paths.size(); ++i)
+        {
+            all_path_nodes.emplace_back(getUniqueID(), std::vector<GraphNode>{start});
+            all_path_nodes[i].path.reserve(all_paths[i].size() + 2);
+
+            for (const auto &node : all_paths[i])
+                all_path_nodes[i].path.emplace_back(node_inf[node].x, node_inf[node].y);
+
+            all_path_nodes[i].path.push_back(end);
+        }
+
+        //Trim beginning of path to remove unnecessary u-turns in path
+        interpolateContractPaths(all_path_nodes, false, false, max_threads);
+
+        return all_path_nodes;
+    }
+
+    void VoronoiPath::moveShortestPathFirst(std::vector<Path> &paths)
+    {
+        if (paths.empty())
+            return;
+
+        std::vector<double> costs(paths.size(), 0);
+        for (int j = 0; j < paths.size(); ++j)
+        {
+            for (int i = 0; i < static_cast<int>(paths[j].path.size()) - 1; ++i)
+                costs[j] += euclideanDist(paths[j].path[i], paths[j].path[i + 1]);
+        }
+
+        int ind = std::distance(costs.begin(), std::min_element(costs.begin(), costs.end()));
+        std::swap(paths[0], paths[ind]);
+    }
+
     std::vector<Path> VoronoiPath::replan(GraphNode &start, GraphNode &end, int num_paths, int &pref_path)
     {
         Profiler complete_profiler, contract_profiler;
@@ -1299,7 +2018,6 @@ namespace voronoi_path
         /********** TRIMMING OR EXTENSION OF PATHS FOUND IN PREVIOUS TIME STEP **********/
         //Add robot's current position to the first pose of the replanned_paths
         bool found_new_start = false;
-        backtrack_paths = false;
         std::vector<Path> replanned_paths(previous_paths);
         for (int i = 0; i < replanned_paths.size(); ++i)
         {
@@ -1345,21 +2063,22 @@ namespace voronoi_path
 
         /********** HOMOTOPY EXPLORATION TO FIND NEW PATHS **********/
         //Explore for potential paths in new homotopy classes
-        std::vector<Path> potential_paths = getPath(start, end, num_paths / 2);
+        bool partial;
+        std::vector<Path> potential_paths = getPath(start, end, num_paths / 2, planning_time_budget, partial);
 
         //Calculate homotopy class of previous set of paths
         Profiler homotopy_profiler;
-        std::vector<std::complex<double>> previous_classes;
-        for (const auto &path : replanned_paths)
-            previous_classes.push_back(calcHomotopyClass(path.path));
+        std::vector<HomotopyClass> previous_classes;
+        for (auto &path : replanned_paths)
+            previous_classes.push_back(getPathHomotopyClass(path));
 
         if (print_timings)
             homotopy_profiler.print("replan homotopy calc");
 
         // Add potential paths that are unique to replanned_paths container
-        for (const auto &path : potential_paths)
+        for (auto &path : potential_paths)
         {
-            std::complex<double> temp_class = calcHomotopyClass(path.path);
+            const HomotopyClass &temp_class = getPathHomotopyClass(path);
             bool unique = true;
             for (const auto &prev_class : previous_classes)
                 if (!isClassDifferent(temp_class, prev_class))
@@ -1418,6 +2137,7 @@ namespace voronoi_path
         //Update previous paths and their costs for the next round of replanning
         previous_paths = replanned_paths;
         previous_path_costs = all_paths_cost;
+        pruneWarmBands();
 
         if (print_timings)
             complete_profiler.print("replan total replan time");
@@ -1425,6 +2145,99 @@ namespace voronoi_path
         return replanned_paths;
     }
 
+    bool VoronoiPath::getNearestNodes(const GraphNode &start, const std::vector<GraphNode> &goals, int &start_node, std::vector<int> &goal_nodes)
+    {
+        double min_start_dist = std::numeric_limits<double>::infinity();
+        std::vector<double> min_goal_dists(goals.size(), std::numeric_limits<double>::infinity());
+        start_node = -1;
+        goal_nodes.assign(goals.size(), -1);
+
+        //Traverse all nodes once, checking distance to start and all goals
+        for (int i = 0; i < num_nodes; ++i)
+        {
+            if (adj_list[i].empty())
+                continue;
+
+            GraphNode curr = node_inf[i];
+            double temp_start_dist = pow(curr.x - start.x, 2) + pow(curr.y - start.y, 2);
+            if (temp_start_dist < min_start_dist && !edgeCollides(start, curr, collision_threshold))
+            {
+                min_start_dist = temp_start_dist;
+                start_node = i;
+            }
+
+            for (int g = 0; g < goals.size(); ++g)
+            {
+                double temp_goal_dist = pow(curr.x - goals[g].x, 2) + pow(curr.y - goals[g].y, 2);
+                if (temp_goal_dist < min_goal_dists[g] && !edgeCollides(goals[g], curr, collision_threshold))
+                {
+                    min_goal_dists[g] = temp_goal_dist;
+                    goal_nodes[g] = i;
+                }
+            }
+        }
+
+        if (start_node == -1)
+        {
+            std::cout << "Failed to find nearest starting node" << std::endl;
+            return false;
+        }
+
+        return true;
+    }
+
+    bool VoronoiPath::shortestPathTree(const int &start_node, const std::vector<int> &targets, std::vector<int> &prev)
+    {
+        std::vector<double> dist(num_nodes, std::numeric_limits<double>::infinity());
+        std::vector<bool> settled(num_nodes, false);
+        prev.assign(num_nodes, -1);
+
+        //Count distinct targets that still need to be settled
+        std::vector<bool> is_target(num_nodes, false);
+        int targets_left = 0;
+        for (const auto &target : targets)
+        {
+            if (target != -1 && !is_target[target])
+            {
+                is_target[target] = true;
+                targets_left++;
+            }
+        }
+
+        std::priority_queue<std::pair<double, int>, std::vector<std::pair<double, int>>, std::greater<std::pair<double, int>>> queue;
+        dist[start_node] = 0;
+        queue.emplace(0, start_node);
+
+        while (!queue.empty() && targets_left > 0)
+        {
+            int curr_node = queue.top().second;
+            queue.pop();
+
+            if (settled[curr_node])
+                continue;
+
+            settled[curr_node] = true;
+            if (is_target[curr_node])
+                targets_left--;
+
+            for (const auto &next_node : adj_list[curr_node])
+            {
+                if (next_node == -1 || settled[next_node])
+                    continue;
+
+                double next_dist = dist[curr_node] + euclideanDist(node_inf[curr_node], node_inf[next_node]);
+                if (next_dist < dist[next_node])
+                {
+                    dist[next_node] = next_dist;
+                    prev[next_node] = curr_node;
+                    queue.emplace(next_dist, next_node);
+                }
+            }
+        }
+
+        return targets_left == 0;
+    }
+
     bool VoronoiPath::getNearestNode(const GraphNode &start, const GraphNode &end, int &start_node, int &end_node)
     {
         bool find_end = true;
@@ -1489,6 +2302,121 @@ namespace voronoi_path
     }
 
     //https://www.cs.huji.ac.il/~jeff/aaai10/02/AAAI10-216.pdf
+    std::complex<double> VoronoiPath::edgeHomotopyValue(const std::complex<double> &from, const std::complex<double> &to)
+    {
+        //Each edge must iterate through all obstacles, done by the vectorized kernel
+        return homotopy_kernel.edgeValue(from, to);
+    }
+
+    void VoronoiPath::computeEdgeHSignatures()
+    {
+        bool use_crossing_word = homotopy_invariant == HomotopyInvariant::CROSSING_WORD;
+        edge_h_signature.clear();
+        edge_crossing_word.clear();
+        if (use_crossing_word)
+        {
+            edge_crossing_word.resize(num_nodes);
+            for (int i = 0; i < num_nodes; ++i)
+                edge_crossing_word[i].resize(adj_list[i].size());
+        }
+
+        else
+        {
+            edge_h_signature.resize(num_nodes);
+            for (int i = 0; i < num_nodes; ++i)
+                edge_h_signature[i].resize(adj_list[i].size());
+        }
+
+        auto computeEdge = [this, use_crossing_word](const int &u, const int &i) {
+            int v = adj_list[u][i];
+            std::complex<double> from(node_inf[u].x, node_inf[u].y);
+            std::complex<double> to(node_inf[v].x, node_inf[v].y);
+            if (use_crossing_word)
+                homotopy_kernel.edgeCrossings(from, to, edge_crossing_word[u][i]);
+
+            else
+                edge_h_signature[u][i] = edgeHomotopyValue(from, to);
+        };
+
+        //Compute each undirected edge once, from its lower numbered node, split across threads
+        int num_threads = std::max<int>(std::thread::hardware_concurrency(), 1);
+        int nodes_per_thread = num_nodes / num_threads + 1;
+        std::vector<std::future<void>> future_vector;
+        future_vector.reserve(num_threads);
+        for (int t = 0; t < num_threads; ++t)
+        {
+            int first_node = t * nodes_per_thread;
+            int last_node = std::min(first_node + nodes_per_thread, num_nodes);
+            future_vector.emplace_back(std::async(std::launch::async, [this, first_node, last_node, &computeEdge]() {
+                for (int u = first_node; u < last_node; ++u)
+                {
+                    for (int i = 0; i < adj_list[u].size(); ++i)
+                    {
+                        if (adj_list[u][i] > u)
+                            computeEdge(u, i);
+                    }
+                }
+            }));
+        }
+
+        for (auto &future : future_vector)
+            future.get();
+
+        //Reverse direction of an edge has the negated contribution, or the inverse crossing word
+        for (int u = 0; u < num_nodes; ++u)
+        {
+            for (int i = 0; i < adj_list[u].size(); ++i)
+            {
+                int v = adj_list[u][i];
+                if (v == -1 || v >= u)
+                    continue;
+
+                auto it = std::find(adj_list[v].begin(), adj_list[v].end(), u);
+                if (it == adj_list[v].end())
+                    computeEdge(u, i);
+
+                else if (use_crossing_word)
+                {
+                    const auto &forward = edge_crossing_word[v][it - adj_list[v].begin()];
+                    for (auto letter = forward.rbegin(); letter != forward.rend(); ++letter)
+                        edge_crossing_word[u][i].push_back(-*letter);
+                }
+
+                else
+                    edge_h_signature[u][i] = -edge_h_signature[v][it - adj_list[v].begin()];
+            }
+        }
+    }
+
+    std::complex<double> VoronoiPath::calcHomotopyClass(const std::vector<int> &path_, const GraphNode *start, const GraphNode *end)
+    {
+        std::complex<double> path_sum(0, 0);
+        if (path_.empty())
+            return path_sum;
+
+        if (start)
+            path_sum += edgeHomotopyValue(std::complex<double>(start->x, start->y), std::complex<double>(node_inf[path_.front()].x, node_inf[path_.front()].y));
+
+        //Sum cached contributions of graph edges
+        bool cached = edge_h_signature.size() == num_nodes;
+        for (int i = 0; i < static_cast<int>(path_.size()) - 1; ++i)
+        {
+            int u = path_[i];
+            int v = path_[i + 1];
+            auto it = std::find(adj_list[u].begin(), adj_list[u].end(), v);
+            if (cached && it != adj_list[u].end())
+                path_sum += edge_h_signature[u][it - adj_list[u].begin()];
+
+            else
+                path_sum += edgeHomotopyValue(std::complex<double>(node_inf[u].x, node_inf[u].y), std::complex<double>(node_inf[v].x, node_inf[v].y));
+        }
+
+        if (end)
+            path_sum += edgeHomotopyValue(std::complex<double>(node_inf[path_.back()].x, node_inf[path_.back()].y), std::complex<double>(end->x, end->y));
+
+        return path_sum;
+    }
+
     std::complex<double> VoronoiPath::calcHomotopyClass(const std::vector<GraphNode> &path_)
     {
         std::vector<std::complex<double>> path;
@@ -1520,27 +2448,11 @@ namespace voronoi_path
                     std::complex<double> path_sum(0, 0);
                     for (int i = start_pose + 1; i < start_pose + poses_per_thread + 1; i++)
                     {
-                        std::complex<double> edge_sum(0, 0);
                         if (i >= path.size())
                             continue;
 
-                        //Each edge must iterate through all obstacles
-                        for (int j = 0; j < centers.size(); ++j)
-                        {
-                            double real_part = std::log(std::abs(path[i] - centers[j])) - std::log(std::abs(path[i - 1] - centers[j]));
-                            double im_part = std::arg(path[i] - centers[j]) - std::arg(path[i - 1] - centers[j]);
-
-                            //Get smallest angle
-                            while (im_part > M_PI)
-                                im_part -= 2 * M_PI;
-
-                            while (im_part < -M_PI)
-                                im_part += 2 * M_PI;
-
-                            edge_sum += (std::complex<double>(real_part, im_part) * obs_coeff[j]);
-                        }
                         //Add this edge's sum to the path sum
-                        path_sum += edge_sum;
+                        path_sum += edgeHomotopyValue(path[i - 1], path[i]);
                     }
 
                     return path_sum;
@@ -1556,47 +2468,210 @@ namespace voronoi_path
         return path_sum;
     }
 
-    bool VoronoiPath::kthShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths)
+    HomotopyClass VoronoiPath::getHomotopyClass(const std::vector<GraphNode> &path_)
     {
-        //Reserve num_paths + 1, + 1 is to store the original shortest path
-        all_paths.reserve(num_paths + 1);
+        HomotopyClass h_class;
+        if (homotopy_invariant == HomotopyInvariant::H_SIGNATURE)
+        {
+            h_class.h_signature = calcHomotopyClass(path_);
+            return h_class;
+        }
 
-        if (num_paths == 0)
+        //Crossings of each segment are found with a binary search over the rays, cheap enough for a single thread
+        std::vector<int> letters;
+        for (int i = 1; i < path_.size(); ++i)
         {
-            all_paths.push_back(shortestPath);
-            return true;
+            letters.clear();
+            homotopy_kernel.edgeCrossings(std::complex<double>(path_[i - 1].x, path_[i - 1].y), std::complex<double>(path_[i].x, path_[i].y), letters);
+            HomotopyKernel::appendReduced(h_class.word, letters);
         }
 
-        //Create container to store accepted kth shortest paths
-        std::vector<std::vector<int>> kthPaths;
-        kthPaths.reserve(num_paths + 1);
-        kthPaths.push_back(shortestPath);
+        h_class.hash = HomotopyKernel::wordHash(h_class.word);
+        return h_class;
+    }
 
-        //Create backup of adjacency as well as modified indices to reduce time required for restoring original list
-        std::vector<std::vector<int>> adj_list_backup(adj_list);
-        std::vector<int> adj_list_modified_ind;
+    HomotopyClass VoronoiPath::getHomotopyClass(const std::vector<int> &path_, const GraphNode *start, const GraphNode *end)
+    {
+        HomotopyClass h_class;
+        if (homotopy_invariant == HomotopyInvariant::H_SIGNATURE)
+        {
+            h_class.h_signature = calcHomotopyClass(path_, start, end);
+            return h_class;
+        }
 
-        //Containers to store candidate kth shortest paths and their costs, and homotopy classes of all accepted paths
-        std::vector<std::pair<double, std::vector<int>>> potentialKth;
-        std::vector<std::complex<double>> homotopy_classes;
+        if (path_.empty())
+        {
+            h_class.hash = HomotopyKernel::wordHash(h_class.word);
+            return h_class;
+        }
 
-        for (int k = 1; k <= num_paths; ++k)
+        std::vector<int> letters;
+        if (start)
         {
-            //Break if cannot find the previous k path, could not find all NUM_PATHS
-            if (k - 1 == kthPaths.size())
-                break;
+            homotopy_kernel.edgeCrossings(std::complex<double>(start->x, start->y), std::complex<double>(node_inf[path_.front()].x, node_inf[path_.front()].y), letters);
+            HomotopyKernel::appendReduced(h_class.word, letters);
+        }
+
+        //Concatenate cached words of graph edges
+        bool cached = edge_crossing_word.size() == num_nodes;
+        for (int i = 0; i < static_cast<int>(path_.size()) - 1; ++i)
+        {
+            int u = path_[i];
+            int v = path_[i + 1];
+            auto it = std::find(adj_list[u].begin(), adj_list[u].end(), v);
+            if (cached && it != adj_list[u].end())
+                HomotopyKernel::appendReduced(h_class.word, edge_crossing_word[u][it - adj_list[u].begin()]);
+
+            else
+            {
+                letters.clear();
+                homotopy_kernel.edgeCrossings(std::complex<double>(node_inf[u].x, node_inf[u].y), std::complex<double>(node_inf[v].x, node_inf[v].y), letters);
+                HomotopyKernel::appendReduced(h_class.word, letters);
+            }
+        }
+
+        if (end)
+        {
+            letters.clear();
+            homotopy_kernel.edgeCrossings(std::complex<double>(node_inf[path_.back()].x, node_inf[path_.back()].y), std::complex<double>(end->x, end->y), letters);
+            HomotopyKernel::appendReduced(h_class.word, letters);
+        }
+
+        h_class.hash = HomotopyKernel::wordHash(h_class.word);
+        return h_class;
+    }
+
+    const HomotopyClass &VoronoiPath::getPathHomotopyClass(Path &path)
+    {
+        const std::vector<GraphNode> &old_path = path.h_class_path;
+        const std::vector<GraphNode> &new_path = path.path;
+        bool valid = path.h_class_version == homotopy_version;
+        if (valid && old_path.size() == new_path.size() && std::equal(old_path.begin(), old_path.end(), new_path.begin()))
+            return path.h_class;
+
+        //Unchanged parts at both ends, they may not overlap
+        int max_common = std::min(old_path.size(), new_path.size());
+        int prefix = 0;
+        while (prefix < max_common && old_path[prefix] == new_path[prefix])
+            ++prefix;
+
+        int suffix = 0;
+        while (suffix < max_common - prefix && old_path[old_path.size() - 1 - suffix] == new_path[new_path.size() - 1 - suffix])
+            ++suffix;
+
+        //Segments that differ, segment i goes from point i to point i + 1
+        int first_segment = std::max(prefix - 1, 0);
+        int old_last_segment = static_cast<int>(old_path.size()) - std::max(suffix, 1);
+        int new_last_segment = static_cast<int>(new_path.size()) - std::max(suffix, 1);
+        int changed_segments = (old_last_segment - first_segment) + (new_last_segment - first_segment);
+
+        //H-signatures are sums over segments, so only changed segments need to be subtracted and added. Crossing words are
+        //recomputed since they are cheap to find and cannot be split without storing the word of every segment
+        if (valid && homotopy_invariant == HomotopyInvariant::H_SIGNATURE && prefix + suffix > 0 && changed_segments < static_cast<int>(new_path.size()) - 1)
+        {
+            for (int i = first_segment; i < old_last_segment; ++i)
+                path.h_class.h_signature -= edgeHomotopyValue(std::complex<double>(old_path[i].x, old_path[i].y), std::complex<double>(old_path[i + 1].x, old_path[i + 1].y));
 
+            for (int i = first_segment; i < new_last_segment; ++i)
+                path.h_class.h_signature += edgeHomotopyValue(std::complex<double>(new_path[i].x, new_path[i].y), std::complex<double>(new_path[i + 1].x, new_path[i + 1].y));
+        }
+
+        else
+            path.h_class = getHomotopyClass(new_path);
+
+        path.h_class_version = homotopy_version;
+        path.h_class_path = new_path;
+        return path.h_class;
+    }
+
+    void VoronoiPath::appendHomotopyClass(HomotopyClass &h_class, const HomotopyClass &next)
+    {
+        if (homotopy_invariant == HomotopyInvariant::CROSSING_WORD)
+        {
+            HomotopyKernel::appendReduced(h_class.word, next.word);
+            h_class.hash = HomotopyKernel::wordHash(h_class.word);
+        }
+
+        else
+            h_class.h_signature += next.h_signature;
+    }
+
+    void VoronoiPath::updateHomotopyObstacles()
+    {
+        if (homotopy_kernel.setObstacles(centers, obs_coeff))
+            homotopy_version++;
+    }
+
+    bool VoronoiPath::kthShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace)
+    {
+        YenState state;
+        resetYenState(state, start_node, end_node, shortestPath);
+        return kthShortestPaths(state, all_paths, num_paths, workspace);
+    }
+
+    void VoronoiPath::resetYenState(YenState &state, const int &start_node, const int &end_node, const std::vector<int> &shortestPath)
+    {
+        state.start_node = start_node;
+        state.end_node = end_node;
+        state.graph_version = graph_version;
+        state.kthPaths.assign(1, shortestPath);
+        state.potentialKth.clear();
+        state.homotopy_classes.clear();
+        state.seen_paths.clear();
+        state.seen_paths[hashPath(shortestPath)].push_back(shortestPath);
+        state.spur_index = 0;
+        state.exhausted = false;
+    }
+
+    bool VoronoiPath::kthShortestPaths(YenState &state, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace, const std::chrono::steady_clock::time_point *deadline)
+    {
+        //Reserve num_paths + 1, + 1 is to store the original shortest path
+        all_paths.reserve(num_paths + 1);
+
+        //Containers to store accepted kth shortest paths, candidate kth shortest paths and their costs, homotopy classes of all
+        //accepted paths, and all paths that have been accepted or were potential kth paths grouped by hash of their node sequence.
+        //These are kept in state so that the search can continue from where it stopped in a later call
+        const int &end_node = state.end_node;
+        std::vector<std::vector<int>> &kthPaths = state.kthPaths;
+        std::vector<std::pair<double, std::vector<int>>> &potentialKth = state.potentialKth;
+        std::vector<HomotopyClass> &homotopy_classes = state.homotopy_classes;
+        std::unordered_map<uint64_t, std::vector<std::vector<int>>> &seen_paths = state.seen_paths;
+
+        //All spur searches share one workspace
+        SearchWorkspace local_workspace;
+        if (!workspace)
+            workspace = &local_workspace;
+
+        //Create working copy of adjacency as well as modified indices to reduce time required for restoring original list.
+        //adj_list itself is never modified, so that it always matches the contraction hierarchy and landmark distances
+        std::vector<std::vector<int>> adj;
+        std::vector<int> adj_list_modified_ind;
+        if (kthPaths.size() < num_paths + 1 && !state.exhausted)
+            adj = adj_list;
+
+        bool timed_out = false;
+        while (kthPaths.size() < num_paths + 1 && !state.exhausted && !timed_out)
+        {
             //Update homotopy classes vector whenever new kth path gets added
-            homotopy_classes.push_back(calcHomotopyClass(convertToPixelPath(kthPaths.back())));
+            if (homotopy_classes.size() < kthPaths.size())
+                homotopy_classes.push_back(getHomotopyClass(kthPaths.back()));
 
             //Spur node is ith node, from start to 2nd last node of path, inclusive
-            for (int i = 0; i < kthPaths[k - 1].size() - 1; ++i)
+            for (; state.spur_index < static_cast<int>(kthPaths.back().size()) - 1; ++state.spur_index)
             {
-                int spurNode = kthPaths[k - 1][i];
+                //Out of time, stop before the next spur so that the search can resume from it
+                if (deadline && std::chrono::steady_clock::now() >= *deadline)
+                {
+                    timed_out = true;
+                    break;
+                }
+
+                int i = state.spur_index;
+                int spurNode = kthPaths.back()[i];
 
                 //Copy root path into container. Root path is path up until spur node, containing the path from start onwards
                 std::vector<int> rootPath(i + 1);
-                std::copy(kthPaths[k - 1].begin(), kthPaths[k - 1].begin() + i + 1, rootPath.begin());
+                std::copy(kthPaths.back().begin(), kthPaths.back().begin() + i + 1, rootPath.begin());
 
                 //Disconnect edges if root path has already been discovered before
                 for (const auto &prevKthPath : kthPaths)
@@ -1616,18 +2691,18 @@ namespace voronoi_path
                     {
                         //Remove edge from spurNode to spur_next by setting spur_next in spurNode's adjacency to -1
                         int spur_next = prevKthPath[i + 1];
-                        auto erase_it = std::find(adj_list[spurNode].begin(), adj_list[spurNode].end(), spur_next);
-                        if (erase_it != adj_list[spurNode].end())
+                        auto erase_it = std::find(adj[spurNode].begin(), adj[spurNode].end(), spur_next);
+                        if (erase_it != adj[spurNode].end())
                         {
-                            adj_list[spurNode][erase_it - adj_list[spurNode].begin()] = -1;
+                            adj[spurNode][erase_it - adj[spurNode].begin()] = -1;
                             adj_list_modified_ind.push_back(spurNode);
                         }
 
                         //Remove edge from spur_next to spurNode by setting spurNode in spur_next's adjacency to -1
-                        erase_it = std::find(adj_list[spur_next].begin(), adj_list[spur_next].end(), spurNode);
-                        if (erase_it != adj_list[spur_next].end())
+                        erase_it = std::find(adj[spur_next].begin(), adj[spur_next].end(), spurNode);
+                        if (erase_it != adj[spur_next].end())
                         {
-                            adj_list[spur_next][erase_it - adj_list[spur_next].begin()] = -1;
+                            adj[spur_next][erase_it - adj[spur_next].begin()] = -1;
                             adj_list_modified_ind.push_back(spur_next);
                         }
                     }
@@ -1638,31 +2713,31 @@ namespace voronoi_path
                 for (int node_ind = 0; node_ind < rootPath.size() - 1; ++node_ind)
                 {
                     int node = rootPath[node_ind];
-                    for (int del_ind = 0; del_ind < adj_list[node].size(); ++del_ind)
+                    for (int del_ind = 0; del_ind < adj[node].size(); ++del_ind)
                     {
                         //Remove connection from point-er side
-                        int pointed_to = adj_list[node][del_ind];
+                        int pointed_to = adj[node][del_ind];
 
                         //Edge is not deleted yet, continue to delete
                         if (pointed_to != -1)
                         {
-                            adj_list[node][del_ind] = -1;
+                            adj[node][del_ind] = -1;
                             adj_list_modified_ind.push_back(node);
 
                             //Remove connection from point-ed side
-                            auto erase_it = std::find(adj_list[pointed_to].begin(), adj_list[pointed_to].end(), node);
-                            if (erase_it != adj_list[pointed_to].end())
+                            auto erase_it = std::find(adj[pointed_to].begin(), adj[pointed_to].end(), node);
+                            if (erase_it != adj[pointed_to].end())
                             {
-                                adj_list[pointed_to][erase_it - adj_list[pointed_to].begin()] = -1;
+                                adj[pointed_to][erase_it - adj[pointed_to].begin()] = -1;
                                 adj_list_modified_ind.push_back(pointed_to);
                             }
                         }
                     }
                 }
 
-                //Find spur path starting from spur node using A* algorithm shortest path searching with modified adj_list
+                //Find spur path starting from spur node using A* algorithm shortest path searching with modified adjacency
                 std::vector<int> spur_path;
-                if (findShortestPath(spurNode, end_node, spur_path))
+                if (findShortestPath(adj, spurNode, end_node, spur_path, nullptr, workspace))
                 {
                     //Create full path from root path and spur path
                     std::vector<int> total_path;
@@ -1670,38 +2745,12 @@ namespace voronoi_path
                         total_path.insert(total_path.begin(), rootPath.begin(), rootPath.end() - 1);
                     total_path.insert(total_path.end(), spur_path.begin(), spur_path.end());
 
-                    //Make sure to check all paths, one container might be bigger. Set last ind to larger container's size
-                    int last = kthPaths.size() > potentialKth.size() ? kthPaths.size() : potentialKth.size();
-
-                    //Check if the path just generated is unique in the potential kth paths
-                    bool path_is_unique = true;
-                    for (int check_path = 0; check_path < last; ++check_path)
-                    {
-                        int kth_equal = 0;
-                        int pot_equal = 0;
-
-                        for (const auto &node_pot : total_path)
-                        {
-                            //Compare with kthPaths
-                            if (check_path < kthPaths.size())
-                            {
-                                if (node_pot < kthPaths[check_path].size())
-                                    if (kthPaths[check_path][node_pot] == total_path[node_pot])
-                                        kth_equal++;
-                            }
-
-                            //Compare with potentialKths
-                            if (check_path < potentialKth.size())
-                            {
-                                if (node_pot < potentialKth[check_path].second.size())
-                                    if (potentialKth[check_path].second[node_pot] == total_path[node_pot])
-                                        pot_equal++;
-                            }
-                        }
-
-                        if (pot_equal == total_path.size() || kth_equal == total_path.size())
-                            path_is_unique = false;
-                    }
+                    //Check if the path just generated is unique among accepted and potential kth paths using its hash,
+                    //full comparison is only done when hashes collide
+                    std::vector<std::vector<int>> &same_hash_paths = seen_paths[hashPath(total_path)];
+                    bool path_is_unique = std::find(same_hash_paths.begin(), same_hash_paths.end(), total_path) == same_hash_paths.end();
+                    if (path_is_unique)
+                        same_hash_paths.push_back(total_path);
 
                     //Add unique path to list of potential kth paths
                     if (path_is_unique)
@@ -1719,15 +2768,24 @@ namespace voronoi_path
 
                 //Reset adj_list before changing spur node
                 for (const auto &modified_node : adj_list_modified_ind)
-                    adj_list[modified_node] = adj_list_backup[modified_node];
+                    adj[modified_node] = adj_list[modified_node];
 
                 adj_list_modified_ind.clear();
                 adj_list_modified_ind.shrink_to_fit();
             }
 
+            if (timed_out)
+                break;
+
+            //All spurs of the latest path have been explored
+            state.spur_index = 0;
+
             //No alternate paths found
             if (potentialKth.size() == 0)
+            {
+                state.exhausted = true;
                 break;
+            }
 
             //Sort costs of paths
             std::sort(potentialKth.begin(), potentialKth.end());
@@ -1738,7 +2796,7 @@ namespace voronoi_path
             while (path_it < potentialKth.end() && h != homotopy_classes.size())
             {
                 //Get homotopy class of the path that is currently being considered
-                std::complex<double> curr_h_class = calcHomotopyClass(convertToPixelPath(path_it->second));
+                HomotopyClass curr_h_class = getHomotopyClass(path_it->second);
                 for (h = 0; h < homotopy_classes.size(); ++h)
                 {
                     //Path is not unique
@@ -1757,125 +2815,204 @@ namespace voronoi_path
                 kthPaths.push_back(std::move(potentialKth[0].second));
                 potentialKth.erase(potentialKth.begin());
             }
+
+            else
+                state.exhausted = true;
         }
 
-        all_paths.insert(all_paths.begin(), kthPaths.begin(), kthPaths.end());
-        if (num_paths == all_paths.size() - 1)
+        int paths_to_copy = std::min<int>(kthPaths.size(), num_paths + 1);
+        all_paths.insert(all_paths.begin(), kthPaths.begin(), kthPaths.begin() + paths_to_copy);
+        if (num_paths == static_cast<int>(all_paths.size()) - 1)
             return true;
 
         else
             return false;
     }
 
-    bool VoronoiPath::findShortestPath(const int &start_node, const int &end_node, std::vector<int> &path)
+    bool VoronoiPath::penaltyShortestPaths(const int &start_node, const int &end_node, const std::vector<int> &shortestPath, std::vector<std::vector<int>> &all_paths, const int &num_paths, SearchWorkspace *workspace, const std::chrono::steady_clock::time_point *deadline)
     {
-        //Create open list, boolean closed_list, and list storing previous node required to reach node at index i
-        std::vector<std::pair<int, NodeInfo>> open_list;
-        std::vector<bool> nodes_closed_bool(num_nodes, false);
-        std::vector<int> nodes_prev(num_nodes, -1);
+        //Reserve num_paths + 1, + 1 is to store the original shortest path
+        all_paths.reserve(num_paths + 1);
+        all_paths.push_back(shortestPath);
 
-        //Variable to store starting node's A* parameters
-        NodeInfo start_info;
-        start_info.cost_upto_here = 0;
-        start_info.cost_to_goal = euclideanDist(node_inf[start_node], node_inf[end_node]);
-        start_info.updateCost();
+        if (num_paths == 0)
+            return true;
 
-        //Place first node into open list to begin exploration
-        open_list.emplace_back(std::make_pair(start_node, start_info));
+        //All searches share one workspace
+        SearchWorkspace local_workspace;
+        if (!workspace)
+            workspace = &local_workspace;
 
-        GraphNode end_node_location = node_inf[end_node];
-        GraphNode next_node_location;
-        NodeInfo curr_node_info;
-        int next_node;
+        //Weight overlay follows the layout of adj_list, all edges start with their original length
+        std::vector<std::vector<double>> edge_weights(num_nodes);
+        for (int i = 0; i < num_nodes; ++i)
+            edge_weights[i].assign(adj_list[i].size(), 1.0);
 
-        //Run until the end_node enters the closed list
-        while (!nodes_closed_bool[end_node])
-        {
-            //Get current node from first item of open list
-            int curr_node = open_list[0].first;
-            GraphNode curr_node_location = node_inf[curr_node];
+        std::vector<HomotopyClass> homotopy_classes;
+        homotopy_classes.push_back(getHomotopyClass(shortestPath));
 
-            //Get info for current node
-            curr_node_info = open_list[0].second;
+        std::vector<int> latest_path = shortestPath;
+        for (int iteration = 0; iteration < penalty_max_iterations && static_cast<int>(all_paths.size()) < num_paths + 1; ++iteration)
+        {
+            //Out of time
+            if (deadline && std::chrono::steady_clock::now() >= *deadline)
+                break;
 
-            //Loop all adjacent nodes of current node
-            for (int i = 0; i < adj_list[curr_node].size(); ++i)
+            //Penalize both directions of every edge used by the latest path found
+            for (int i = 0; i < static_cast<int>(latest_path.size()) - 1; ++i)
             {
-                next_node = adj_list[curr_node][i];
+                int from = latest_path[i];
+                int to = latest_path[i + 1];
 
-                //Edge has been deleted or node is already in closed list
-                if (next_node == -1 || nodes_closed_bool[next_node])
-                    continue;
+                auto it = std::find(adj_list[from].begin(), adj_list[from].end(), to);
+                if (it != adj_list[from].end())
+                    edge_weights[from][it - adj_list[from].begin()] *= penalty_factor;
 
-                //Get the location of the next node
-                next_node_location = node_inf[next_node];
-
-                //Calculate cost upto the next node from curr node
-                double curr_to_next_dist = euclideanDist(curr_node_location, next_node_location) + curr_node_info.cost_upto_here;
+                it = std::find(adj_list[to].begin(), adj_list[to].end(), from);
+                if (it != adj_list[to].end())
+                    edge_weights[to][it - adj_list[to].begin()] *= penalty_factor;
+            }
 
-                //Find next_node in open_list to check whether or not to add into open list
-                auto it = std::find_if(open_list.begin(), open_list.end(),
-                                       [&next_node](const std::pair<int, NodeInfo> &in) {
-                                           return in.first == next_node;
-                                       });
+            //Search again on the same topology with the penalized weights
+            std::vector<int> new_path;
+            if (!findShortestPath(start_node, end_node, new_path, &edge_weights, workspace))
+                break;
 
-                //If node is not in open list yet, add to open list
-                if (it == open_list.end())
+            //Accept path only if it is in a different homotopy class from all accepted paths
+            HomotopyClass curr_h_class = getHomotopyClass(new_path);
+            bool unique = true;
+            for (const auto &h_class : homotopy_classes)
+            {
+                if (!isClassDifferent(curr_h_class, h_class))
                 {
-                    NodeInfo new_node;
-                    new_node.cost_upto_here = curr_to_next_dist;
-                    new_node.cost_to_goal = euclideanDist(end_node_location, next_node_location);
-                    new_node.updateCost();
-                    nodes_prev[next_node] = curr_node;
-
-                    open_list.emplace_back(std::make_pair(next_node, new_node));
+                    unique = false;
+                    break;
                 }
+            }
 
-                //Update open list's cost if this new cost is smaller
-                else
-                {
-                    //Update node's nearest distance to reach here, if the new cost is lower
-                    if (curr_to_next_dist < it->second.cost_upto_here)
-                    {
-                        //Update cost upto here. Cost to goal doesn't change
-                        it->second.cost_upto_here = curr_to_next_dist;
-                        it->second.updateCost();
-                        nodes_prev[next_node] = curr_node;
-                    }
-                }
+            if (unique)
+            {
+                homotopy_classes.push_back(curr_h_class);
+                all_paths.push_back(new_path);
             }
 
-            //Remove curr_node from open list after all adjacent nodes have been put into open list
-            open_list.erase(open_list.begin());
+            latest_path = std::move(new_path);
+        }
 
-            //Then put into closed list
-            nodes_closed_bool[curr_node] = true;
+        if (num_paths == static_cast<int>(all_paths.size()) - 1)
+            return true;
 
-            //Sort open list by ascending total cost
-            if (!open_list.empty())
-            {
-                //Sort by pair's second element.total_cost
-                std::sort(open_list.begin(), open_list.end(), [](std::pair<int, NodeInfo> &left, std::pair<int, NodeInfo> &right) {
-                    return left.second.total_cost < right.second.total_cost;
-                });
-            }
+        else
+            return false;
+    }
+
+    bool VoronoiPath::findIncrementalPath(const int &start_node, const int &end_node, std::vector<int> &path)
+    {
+        //New goal, previous search tree is not reusable
+        if (incremental_search.getGoal() != end_node)
+            incremental_search.reset(adj_list, node_inf, start_node, end_node);
+
+        else
+            incremental_search.updateStart(start_node);
+
+        bool found = incremental_search.computeShortestPath(path);
+
+        if (print_timings)
+            std::cout << "findIncrementalPath expanded nodes: " << incremental_search.getExpansions() << "\n";
+
+        return found;
+    }
+
+    bool VoronoiPath::findShortestPath(const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay, SearchWorkspace *workspace)
+    {
+        //Contraction hierarchy only holds the unmodified edge weights
+        if (weight_overlay == nullptr && contraction_hierarchy.isBuilt())
+            return contraction_hierarchy.query(start_node, end_node, path);
+
+        return findShortestPath(adj_list, start_node, end_node, path, weight_overlay, workspace);
+    }
+
+    bool VoronoiPath::findShortestPath(const std::vector<std::vector<int>> &adj, const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay, SearchWorkspace *workspace)
+    {
+        //Use caller's workspace if available to avoid reallocating for every search
+        SearchWorkspace local_workspace;
+        SearchWorkspace &ws = workspace ? *workspace : local_workspace;
+        ws.prepare(num_nodes);
+
+        //Long range queries are searched from both ends
+        bool bidirectional = ws.mode == SearchMode::BIDIRECTIONAL ||
+                             (ws.mode == SearchMode::AUTO && bidirectional_search_threshold > 0 &&
+                              euclideanDist(node_inf[start_node], node_inf[end_node]) * map_ptr->resolution > bidirectional_search_threshold);
+        if (bidirectional)
+            return bidirectionalSearch(adj, start_node, end_node, path, weight_overlay, ws);
+
+        //Open list is a binary min heap of (total cost, node). Stale entries are skipped when popped
+        typedef std::pair<double, int> QueueItem;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> open_list;
+
+        //Place first node into open list to begin exploration
+        ws.cost_upto_here[start_node] = 0;
+        ws.touched.push_back(start_node);
+        open_list.emplace(heuristic(start_node, end_node), start_node);
 
+        //Run until the end_node enters the closed list
+        while (!ws.closed[end_node])
+        {
             //No path is found since end node is not in closed list and open list is empty
-            else
+            if (open_list.empty())
                 return false;
+
+            //Get current node from top of open list
+            int curr_node = open_list.top().second;
+            open_list.pop();
+
+            if (ws.closed[curr_node])
+                continue;
+
+            //Put into closed list
+            ws.closed[curr_node] = true;
+            GraphNode curr_node_location = node_inf[curr_node];
+
+            //Loop all adjacent nodes of current node
+            for (int i = 0; i < static_cast<int>(adj[curr_node].size()); ++i)
+            {
+                int next_node = adj[curr_node][i];
+
+                //Edge has been deleted or node is already in closed list
+                if (next_node == -1 || ws.closed[next_node])
+                    continue;
+
+                //Calculate cost upto the next node from curr node, scaled by the overlay's multiplier if available
+                double edge_cost = euclideanDist(curr_node_location, node_inf[next_node]);
+                if (weight_overlay)
+                    edge_cost *= (*weight_overlay)[curr_node][i];
+
+                double curr_to_next_dist = edge_cost + ws.cost_upto_here[curr_node];
+
+                //Update node's nearest distance to reach here, if the new cost is lower
+                if (curr_to_next_dist < ws.cost_upto_here[next_node])
+                {
+                    if (ws.cost_upto_here[next_node] == std::numeric_limits<double>::infinity())
+                        ws.touched.push_back(next_node);
+
+                    ws.cost_upto_here[next_node] = curr_to_next_dist;
+                    ws.prev[next_node] = curr_node;
+                    open_list.emplace(curr_to_next_dist + heuristic(next_node, end_node), next_node);
+                }
+            }
         }
 
         //Put nodes into path
         std::vector<int> temp_path;
 
-        //Find path starting from end_node, using nodes_prev to backtrack path
+        //Find path starting from end_node, using prev to backtrack path
         int path_current_node = end_node;
         temp_path.push_back(path_current_node);
 
         //Loop until start_node has been reached
         while (path_current_node != start_node)
         {
-            path_current_node = nodes_prev[path_current_node];
+            path_current_node = ws.prev[path_current_node];
 
             //If previous node does not exist, dead end. Path does not exist
             if (path_current_node == -1)
@@ -1890,6 +3027,96 @@ namespace voronoi_path
         return true;
     }
 
+    bool VoronoiPath::bidirectionalSearch(const std::vector<std::vector<int>> &adj, const int &start_node, const int &end_node, std::vector<int> &path, const std::vector<std::vector<double>> *weight_overlay, SearchWorkspace &ws)
+    {
+        //Average potential, forward search uses potential(v) and backward search uses -potential(v)
+        auto potential = [&](const int &node) {
+            return (heuristic(node, end_node) - heuristic(node, start_node)) / 2.0;
+        };
+
+        typedef std::pair<double, int> QueueItem;
+        std::priority_queue<QueueItem, std::vector<QueueItem>, std::greater<QueueItem>> open_list[2];
+        std::vector<double> *cost[2] = {&ws.cost_upto_here, &ws.cost_to_end};
+        std::vector<int> *parent[2] = {&ws.prev, &ws.next};
+        std::vector<bool> *closed[2] = {&ws.closed, &ws.closed_reverse};
+
+        ws.cost_upto_here[start_node] = 0;
+        ws.cost_to_end[end_node] = 0;
+        ws.touched.push_back(start_node);
+        ws.touched.push_back(end_node);
+        open_list[0].emplace(potential(start_node), start_node);
+        open_list[1].emplace(-potential(end_node), end_node);
+
+        //Length of best path found so far, and node where both searches meet on that path
+        double best_cost = start_node == end_node ? 0 : std::numeric_limits<double>::infinity();
+        int meeting_node = start_node == end_node ? start_node : -1;
+
+        while (!open_list[0].empty() && !open_list[1].empty())
+        {
+            //With consistent potentials, no shorter path exists once the sum of smallest keys reaches the best path
+            if (open_list[0].top().first + open_list[1].top().first >= best_cost)
+                break;
+
+            //Expand the search with the smaller open list
+            int dir = open_list[0].size() <= open_list[1].size() ? 0 : 1;
+            int curr_node = open_list[dir].top().second;
+            open_list[dir].pop();
+
+            if ((*closed[dir])[curr_node])
+                continue;
+
+            (*closed[dir])[curr_node] = true;
+            GraphNode curr_node_location = node_inf[curr_node];
+
+            for (int i = 0; i < adj[curr_node].size(); ++i)
+            {
+                int next_node = adj[curr_node][i];
+                if (next_node == -1 || (*closed[dir])[next_node])
+                    continue;
+
+                double edge_cost = euclideanDist(curr_node_location, node_inf[next_node]);
+                if (weight_overlay)
+                    edge_cost *= (*weight_overlay)[curr_node][i];
+
+                double next_cost = (*cost[dir])[curr_node] + edge_cost;
+                if (next_cost < (*cost[dir])[next_node])
+                {
+                    if (ws.cost_upto_here[next_node] == std::numeric_limits<double>::infinity() &&
+                        ws.cost_to_end[next_node] == std::numeric_limits<double>::infinity())
+                        ws.touched.push_back(next_node);
+
+                    (*cost[dir])[next_node] = next_cost;
+                    (*parent[dir])[next_node] = curr_node;
+                    open_list[dir].emplace(next_cost + (dir == 0 ? potential(next_node) : -potential(next_node)), next_node);
+
+                    //Both searches have reached this node, update best path
+                    double total_cost = next_cost + (*cost[1 - dir])[next_node];
+                    if (total_cost < best_cost)
+                    {
+                        best_cost = total_cost;
+                        meeting_node = next_node;
+                    }
+                }
+            }
+        }
+
+        if (meeting_node == -1)
+            return false;
+
+        //Forward half from start to meeting node, then backward half from meeting node to end
+        std::vector<int> temp_path;
+        for (int node = meeting_node; node != -1; node = ws.prev[node])
+            temp_path.push_back(node);
+
+        std::reverse(temp_path.begin(), temp_path.end());
+        for (int node = ws.next[meeting_node]; node != -1; node = ws.next[node])
+            temp_path.push_back(node);
+
+        path.insert(path.end(), temp_path.begin(), temp_path.end());
+
+        return true;
+    }
+
     void VoronoiPath::removeObstacleVertices(std::vector<const jcv_edge *> &edge_vector)
     {
         //Get edge vertices that are in obtacle
@@ -2088,38 +3315,63 @@ namespace voronoi_path
 
     bool VoronoiPath::interpolatePaths(std::vector<Path> &paths, double path_waypoint_sep)
     {
-        //Calculate minimum distance between two poses in path should have, distance in pix squared
-        double waypoint_sep_sq = path_waypoint_sep * path_waypoint_sep / (map_ptr->resolution * map_ptr->resolution);
+        //Number of waypoints per pixel, segments longer than the separation are split into floor(length / sep) parts
+        double inv_waypoint_sep = map_ptr->resolution / path_waypoint_sep;
+        const int width = map_ptr->width;
+        const int height = map_ptr->height;
+        const signed char *data = map_ptr->data.data();
+
+        std::vector<int> segment_steps;
+        std::vector<GraphNode> resampled;
         for (auto &path : paths)
         {
+            if (path.path.size() < 2)
+                continue;
+
+            //First pass finds the number of parts of every segment, so that the output is allocated once
+            segment_steps.resize(path.path.size());
+            int max_size = 1;
             for (int i = 1; i < path.path.size(); ++i)
             {
-                double sq_dist = pow(path.path[i].x - path.path[i - 1].x, 2) + pow(path.path[i].y - path.path[i - 1].y, 2);
-
-                //Current point and previous point are too far apart, interpolate to get points in between
-                if (sq_dist > waypoint_sep_sq)
-                {
-                    //sqrt steps because sq_dist and waypoint_sep_sq are squared. 1/0.2 != 1/0.04
-                    int steps = sqrt(sq_dist / waypoint_sep_sq);
-                    GraphNode prev_point = path.path[i - 1];
-                    GraphNode curr_point = path.path[i];
-                    GraphNode interp_point;
-                    int insert_position = i;
-
-                    for (int j = 1; j < steps; ++j)
-                    {
-                        interp_point.x = prev_point.x * (steps - j) / (double)steps + curr_point.x * (j) / (double)steps;
-                        interp_point.y = prev_point.y * (steps - j) / (double)steps + curr_point.y * (j) / (double)steps;
+                double dx = path.path[i].x - path.path[i - 1].x;
+                double dy = path.path[i].y - path.path[i - 1].y;
+                segment_steps[i] = std::max(static_cast<int>(std::sqrt(dx * dx + dy * dy) * inv_waypoint_sep), 1);
+                max_size += segment_steps[i];
+            }
 
-                        //Insert if no collision, .insert will make the nth element your new item
-                        if(!edgeCollides(interp_point, interp_point, collision_threshold))
-                            path.path.insert(path.path.begin() + (insert_position++), interp_point);
+            if (max_size == path.path.size())
+                continue;
 
-                        //Incrememnt i because a node has been inserted before i
-                        ++i;
-                    }
+            //Second pass writes original points and interpolated points that are not in collision, in order
+            resampled.clear();
+            resampled.reserve(max_size);
+            resampled.push_back(path.path[0]);
+            for (int i = 1; i < path.path.size(); ++i)
+            {
+                const GraphNode &prev_point = path.path[i - 1];
+                const GraphNode &curr_point = path.path[i];
+                const int steps = segment_steps[i];
+                const double inv_steps = 1.0 / steps;
+                const double step_x = (curr_point.x - prev_point.x) * inv_steps;
+                const double step_y = (curr_point.y - prev_point.y) * inv_steps;
+
+                for (int j = 1; j < steps; ++j)
+                {
+                    GraphNode interp_point(prev_point.x + step_x * j, prev_point.y + step_y * j);
+
+                    //Occupancy looked up directly, points outside the map are kept as edgeCollides does not reject them
+                    int cell_x = std::floor(interp_point.x);
+                    int cell_y = std::floor(interp_point.y);
+                    bool in_map = cell_x >= 0 && cell_y >= 0 && cell_x < width && cell_y < height;
+                    if (!in_map || data[cell_x + cell_y * width] <= collision_threshold)
+                        resampled.push_back(interp_point);
                 }
+
+                resampled.push_back(curr_point);
             }
+
+            //Old points are kept in the buffer, its capacity is reused by the next path
+            path.path.swap(resampled);
         }
 
         return true;
@@ -2129,6 +3381,7 @@ namespace voronoi_path
     {
         previous_paths.clear();
         previous_path_costs.clear();
+        pruneWarmBands();
 
         return true;
     }
@@ -2143,6 +3396,14 @@ namespace voronoi_path
         return std::abs(complex_1 - complex_2) / std::abs(complex_1) > h_class_threshold;
     }
 
+    bool VoronoiPath::isClassDifferent(const HomotopyClass &class_1, const HomotopyClass &class_2)
+    {
+        if (homotopy_invariant == HomotopyInvariant::CROSSING_WORD)
+            return class_1.hash != class_2.hash;
+
+        return isClassDifferent(class_1.h_signature, class_2.h_signature);
+    }
+
     bool VoronoiPath::removeExcessBranch(std::vector<std::vector<int>> &new_adj_list, double thresh, int curr_node, int prev_node, double cum_dist)
     {
         //Branch is too long, break premptively
@@ -2183,11 +3444,4 @@ namespace voronoi_path
         //Should not reach here
         return false;
     }
-
-
-    bool VoronoiPath::liesInSquare(const GraphNode & point, const GraphNode & line_point_a, const GraphNode & line_point_b)
-    {
-        //Checks if the point lies in a square form
-        return (point.x - line_point_a.x) * (point.x - line_point_b.x) < 0.0 && (point.y - line_point_a.y) * (point.y - line_point_b.y) < 0.0;
-    }
 } // namespace voronoi_path